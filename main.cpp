@@ -5,6 +5,50 @@
 #include <algorithm>
 #include <random>
 #include <ctime>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <sstream>
+#include <iterator>
+#include <type_traits>
+#include <tuple>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <functional>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_set>
+#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <spawn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <climits>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#if defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cerrno>
+#define DP_HAVE_IO_URING
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using Atom = int;
 using Literal = int;
@@ -12,375 +56,6829 @@ using Clause = std::set<Literal>;
 using NormalForm = std::set<Clause>;
 
 /**
-* @struct DP
-* Represents a data structure used for processing and manipulating logical formulas in conjunctive normal form (CNF).
+* @struct BasicResolventBatch
+* Represents a batch of resolvents stored as flat, sorted literal sequences.
 *
-* This struct maintains sets of literals, including the set of all literals and the set of false literals.
-* It provides various methods for analyzing and modifying the normal form of the formula.
+* Resolvents produced by eliminating one variable are collected here instead of being inserted into the normal form
+*  one by one. The batch is then deduplicated at once with an LSD radix sort over the length and the hash of the clauses,
+*  comparing literals only inside groups of equal keys.
+*
+* When compressed, every resolvent is stored as its first literal followed by the gaps between consecutive literals,
+*  all as variable-length integers of 7 bits per byte. Gaps of sorted literals are small, so most literals take
+*  a single byte instead of four. The encoding of a clause is unique, so duplicates are found by comparing bytes,
+*  and resolvents are only decoded where their literals are needed.
+*
+* The literals are stored as StoredLiteral and the ends of the resolvents as Offset, so formulas with few atoms
+*  can use narrower literals while huge batches need 64-bit offsets.
 */
-struct DP {
-    std::set<Literal> literals;
-    std::set<Literal> falseLiterals;
+template <typename StoredLiteral, typename Offset>
+struct BasicResolventBatch {
+    std::vector<StoredLiteral> literals;    // literals of the resolvents, or of the last one being built when compressed
+    std::vector<Offset> offsets{ 0 };
+    std::vector<uint32_t> hashes;
+
+    bool compress = false;
+    std::vector<uint8_t> bytes;        // encoded resolvents when compressed
+    std::vector<uint32_t> lengths;     // number of literals of every resolvent when compressed
+    size_t peakMemory = 0;             // largest number of bytes taken by the resolvents since the last clear
 
     /**
-    * @brief Prints the given normal form of the formula.
-    *
-    * @param f The normal form of the formula to be printed.
+    * @brief Removes all resolvents from the batch, keeping the allocated memory.
     */
-    void print(const NormalForm& f) {
-        for (const Clause& clause : f) {
-            std::cout << "[ ";
-            for (const Literal& literal : clause)
-                std::cout << literal << " ";
-            std::cout << "]";
-        }
-        std::cout << std::endl;
+    void clear() {
+        literals.clear();
+        offsets.assign(1, 0);
+        hashes.clear();
+        bytes.clear();
+        lengths.clear();
     }
 
     /**
-    * @brief Checks if a given clause is tautological.
-    *
-    * Clause is tautological if it contains both a literal and its negation.
-    *
-    * @param clause The clause to be checked.
-    * @return bool True if the clause is tautological, false otherwise.
+    * @brief Returns the number of bytes taken by the literals of the resolvents.
     */
-    bool isTautologicClause(const Clause& clause) {
-        std::set<Literal> seenLiterals;
-        for (const Literal& literal : clause) {
-            if (seenLiterals.find(-literal) != seenLiterals.end()) return true;
-            seenLiterals.insert(literal);
-        }
-
-        return false;
+    size_t memory() const {
+        return compress ? bytes.size() + lengths.size() * sizeof(uint32_t) + offsets.size() * sizeof(Offset)
+                        : literals.size() * sizeof(StoredLiteral) + offsets.size() * sizeof(Offset);
     }
 
     /**
-    * @brief Removes all tautological clauses from the given normal form.
+    * @brief Returns the number of resolvents in the batch.
     *
-    * @param f The normal form of the formula, which will be modified.
+    * @return size_t The number of resolvents.
     */
-    void removeAllTautologyClauses(NormalForm& f) {
-        for (auto it = f.begin(); it != f.end(); )
-            if (isTautologicClause(*it)) it = f.erase(it);
-            else ++it;
+    size_t size() const {
+        return hashes.size();
     }
 
     /**
-    * @brief Checks if a given clause is a unit clause, meaning it contains only one literal.
+    * @brief Returns the number of literals of the resolvent with the given index.
     *
-    * @param clause The clause to be checked.
-    * @return bool True if the clause is a unit clause, false otherwise.
+    * @param index The index of the resolvent.
+    * @return size_t The length of the resolvent.
     */
-    bool isUnitClause(const Clause& clause) {
-        return clause.size() == 1;
+    size_t length(size_t index) const {
+        return compress ? lengths[index] : offsets[index + 1] - offsets[index];
     }
 
     /**
-    * @brief Removes all false literals from the clauses in the given normal form.
+    * @brief Returns the pointer to the first literal of the resolvent with the given index, if not compressed.
     *
-    * @param f The normal form of the formula, which will be modified.
-    * @param conflict Bool value that becomes yes if the clause becomes empty.
+    * @param index The index of the resolvent.
+    * @return const StoredLiteral* The pointer to the sorted literals of the resolvent.
     */
-    void removeFalseLiterals(NormalForm& f, bool& conflict) {
-        for (auto it = f.begin(); it != f.end(); ) {
-            bool clauseModified = false;
-            Clause newClause;
-            for (const Literal& literal : *it)
-                if (falseLiterals.find(literal) != falseLiterals.end()) clauseModified = true;
-                else newClause.insert(literal);
+    const StoredLiteral* begin(size_t index) const {
+        return literals.data() + offsets[index];
+    }
 
-            if (clauseModified) {
-                if (newClause.empty()) {
-                    conflict = true;
-                    return;  // UNSAT - empty clause
-                }
+    /**
+    * @brief Returns the literals of the resolvent with the given index, decoding or widening them if needed.
+    *
+    * @param index The index of the resolvent.
+    * @param buffer The buffer the literals are decoded into, which is returned unless they are stored as they are.
+    * @return const Literal* The pointer to the sorted literals of the resolvent.
+    */
+    const Literal* decode(size_t index, std::vector<Literal>& buffer) const {
+        buffer.clear();
+        if (!compress) {
+            if constexpr (std::is_same_v<StoredLiteral, Literal>) return begin(index);
+            buffer.assign(begin(index), begin(index) + length(index));
+            return buffer.data();
+        }
 
-                it = f.erase(it);
-                if (!newClause.empty()) {
-                    if (isUnitClause(newClause)) {
-                        falseLiterals.insert(-(*newClause.begin()));
-                        it = f.begin(); // potentially remove newly unlocked false literals
-                    }
-                    else f.insert(newClause);
-                }
+        const uint8_t* p = bytes.data() + offsets[index];
+        uint32_t previous = 0;
+        for (uint32_t i = 0; i < lengths[index]; i++) {
+            uint32_t value = 0;
+            for (unsigned shift = 0; ; shift += 7) {
+                value |= static_cast<uint32_t>(*p & 0x7f) << shift;
+                if (!(*p++ & 0x80)) break;
             }
-            else ++it;
+            // The first literal is zigzag encoded, the following ones are positive gaps
+            previous = i == 0 ? (value >> 1) ^ -(value & 1) : previous + value;
+            buffer.push_back(static_cast<Literal>(previous));
         }
+        return buffer.data();
     }
 
     /**
-    * @brief Removes all unit clauses from the given normal form and updates the set of false literals accordingly.
+    * @brief Moves the resolvent built at the end of literals into the encoded bytes.
     *
-    * @param f The normal form of the formula, which will be modified.
-    * @param conflict Bool value that becomes yes if there are conflict clauses.
+    * @param start The position of the first literal of the resolvent in literals.
     */
-    void removeUnitClauses(NormalForm& f, bool& conflict) {
-        for (auto it = f.begin(); it != f.end(); ) {
-            if (isUnitClause(*it)) {
-                Literal unitLiteral = *it->begin();
-                if (falseLiterals.find(unitLiteral) != falseLiterals.end()) {
-                    conflict = true;
-                    return;  // UNSAT - conflict clauses
-                }
-
-                falseLiterals.insert(-unitLiteral);
-                it = f.erase(it);
-            }
-            else ++it;
+    void encode(size_t start) {
+        uint32_t previous = 0;
+        for (size_t i = start; i < literals.size(); i++) {
+            const uint32_t literal = static_cast<uint32_t>(static_cast<Literal>(literals[i]));
+            uint32_t value = i == start ? (literal << 1) ^ -(literal >> 31) : literal - previous;
+            previous = literal;
+            for (; value >= 0x80; value >>= 7) bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            bytes.push_back(static_cast<uint8_t>(value));
         }
+        lengths.push_back(literals.size() - start);
+        literals.resize(start);
+    }
 
-        if (!falseLiterals.empty())
-            removeFalseLiterals(f, conflict);
+    /**
+    * @brief Checks if the resolvents with the given indices are equal.
+    */
+    bool equal(size_t a, size_t b) const {
+        if (length(a) != length(b)) return false;
+        if (!compress) return std::equal(begin(a), begin(a) + length(a), begin(b));
+        return offsets[a + 1] - offsets[a] == offsets[b + 1] - offsets[b] &&
+               std::equal(bytes.begin() + offsets[a], bytes.begin() + offsets[a + 1], bytes.begin() + offsets[b]);
     }
 
     /**
-    * @brief Checks if a given literal is a pure literal.
+    * @brief Resolves two clauses on a given literal and appends the resolvent to the batch.
     *
-    * A pure literal is a literal that appears only with one sign (either positive or negative) in the entire formula.
-    * This function iterates through all clauses and checks if they contain pure literals.
+    * Both clauses are already sorted, so the resolvent is produced by merging them, skipping the target literal and its negation.
+    *  Tautological resolvents are dropped.
     *
-    * @param literal The literal to be checked.
-    * @param f The normal form of the formula.
-    * @return bool True if the literal is a pure literal, false otherwise.
+    * @param first The clause containing the target literal.
+    * @param second The clause containing the negation of the target literal.
+    * @param target The literal on which the resolution is performed.
+    * @return bool True if the resolvent was added, false if it was tautological.
     */
-    bool isPureLiteral(const Literal& literal, const NormalForm& f) {
-        for (const Clause& clause : f)
-            if (clause.find(-literal) != clause.end()) return false;
+    bool addResolvent(const Clause& first, const Clause& second, const Literal& target) {
+        const size_t start = literals.size();
+        auto a = first.begin(), b = second.begin();
+        while (a != first.end() || b != second.end()) {
+            Literal literal;
+            if (b == second.end() || (a != first.end() && *a < *b)) literal = *a++;
+            else if (a == first.end() || *b < *a) literal = *b++;
+            else { literal = *a++; ++b; }
+
+            if (literal != target && literal != -target) literals.push_back(static_cast<StoredLiteral>(literal));
+        }
+
+        if (isTautological(literals.data() + start, literals.size() - start)) {
+            literals.resize(start);
+            return false;
+        }
+
+        uint32_t hash = 2166136261u;
+        for (size_t i = start; i < literals.size(); i++)
+            hash = (hash ^ static_cast<uint32_t>(literals[i])) * 16777619u;
 
+        if (compress) encode(start);
+        offsets.push_back(static_cast<Offset>(compress ? bytes.size() : literals.size()));
+        hashes.push_back(hash);
+        peakMemory = std::max(peakMemory, memory());
         return true;
     }
 
     /**
-    * @brief Removes all clauses containing the given pure literal from the normal form.
+    * @brief Checks if the sorted sequence of literals contains both a literal and its negation.
     *
-    * @param f The normal form of the formula, which will be modified.
-    * @param pureLiteral The pure literal to be removed.
+    * Negative literals come first in decreasing absolute value, so they are walked backwards together with the positive ones.
+    *
+    * @param first The pointer to the first literal.
+    * @param count The number of literals.
+    * @return bool True if the sequence is tautological, false otherwise.
     */
-    void removePureClausesByLiteral(NormalForm& f, const Literal& pureLiteral) {
-        for (auto it = f.begin(); it != f.end(); )
-            if (it->find(pureLiteral) != it->end()) it = f.erase(it);
-            else ++it;
+    template <typename Stored>
+    static bool isTautological(const Stored* first, size_t count) {
+        const Stored* positive = std::upper_bound(first, first + count, Stored(0));
+        const Stored* negative = positive;
+        const Stored* last = first + count;
+        while (negative != first && positive != last) {
+            if (-*(negative - 1) < *positive) --negative;
+            else if (*positive < -*(negative - 1)) ++positive;
+            else return true;
+        }
+
+        return false;
     }
 
     /**
-    * @brief Removes pure clauses from the given normal form.
-    *
-    * This function iterates through all literals and removes the clauses containing the pure literals.
+    * @brief Sorts the resolvents by their length and hash using an LSD radix sort with 8-bit digits.
     *
-    * @param f The normal form from which the pure clauses should be removed.
+    * @return std::vector<size_t> The indices of the resolvents in sorted order.
     */
-    void removePureClauses(NormalForm& f) {
-        for (const Literal& literal : literals)
-            if (isPureLiteral(literal, f))
-                removePureClausesByLiteral(f, literal);
+    std::vector<size_t> radixOrder() const {
+        std::vector<size_t> order(size()), buffer(size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = i;
+
+        size_t maxLength = 0;
+        for (size_t i = 0; i < size(); i++) maxLength = std::max(maxLength, length(i));
+
+        size_t count[256];
+        auto pass = [&](auto digit) {
+            std::fill(count, count + 256, 0);
+            for (size_t index : order) count[digit(index)]++;
+            size_t sum = 0;
+            for (size_t& c : count) { size_t next = sum + c; c = sum; sum = next; }
+            for (size_t index : order) buffer[count[digit(index)]++] = index;
+            order.swap(buffer);
+        };
+
+        for (unsigned shift = 0; shift < 32; shift += 8)
+            pass([&](size_t i) { return (hashes[i] >> shift) & 0xff; });
+        for (unsigned shift = 0; (maxLength >> shift) != 0; shift += 8)
+            pass([&](size_t i) { return (length(i) >> shift) & 0xff; });
+
+        return order;
     }
 
     /**
-    * @brief Retrieves all clauses in the given normal form that contain the specified literal.
+    * @brief Finds the distinct resolvents of the batch.
     *
-    * This function iterates through all clauses in the normal form and adds the clauses that contain the target literal to the result vector.
+    * After the radix sort equal resolvents are adjacent to each other, up to hash collisions,
+    *  so literals are only compared between resolvents with the same length and hash.
     *
-    * @param f The normal form to search through.
-    * @param target The literal to search for in the clauses.
-    * @return std::vector<Clause> A vector containing all clauses that include the target literal.
+    * @return std::vector<size_t> The indices of the distinct resolvents.
     */
-    std::vector<Clause> allClausesWithGivenLiteral(const NormalForm& f, const Literal& target) {
-        std::vector<Clause> result;
-        for (const auto& clause : f)
-            if (clause.find(target) != clause.end()) result.push_back(clause);
+    std::vector<size_t> deduplicate() const {
+        std::vector<size_t> order = radixOrder();
+        std::vector<size_t> unique;
+        size_t groupStart = 0;
+        for (size_t i = 0; i < order.size(); i++) {
+            const size_t index = order[i];
+            if (i == 0 || hashes[index] != hashes[order[i - 1]] || length(index) != length(order[i - 1]))
+                groupStart = unique.size();
 
-        return result;
+            bool duplicate = false;
+            for (size_t j = groupStart; j < unique.size() && !duplicate; j++)
+                duplicate = equal(index, unique[j]);
+
+            if (!duplicate) unique.push_back(index);
+        }
+
+        return unique;
     }
+};
 
+// Batches with the literals of the parser, and with narrow literals for formulas with at most narrowAtoms atoms
+using ResolventBatch = BasicResolventBatch<Literal, size_t>;
+using NarrowResolventBatch = BasicResolventBatch<int16_t, uint32_t>;
+constexpr Atom narrowAtoms = INT16_MAX;
+
+/**
+* @struct ClauseTrie
+* Represents an index of clauses as a trie over their sorted literals, used for subsumption queries.
+*
+* Clauses sharing a prefix share the nodes of that prefix, which pays off on resolvents, as the resolvents of one
+*  clause with many others all start alike. Every node counts the clauses ending below it, so a removed clause
+*  releases exactly the nodes no other clause uses, and released nodes are reused by later insertions.
+*/
+struct ClauseTrie {
     /**
-    * @brief Resolves two clauses on a given literal, producing a new clause.
-    *
-    * The resolution operation is a fundamental inference rule in propositional logic.
-    *  It takes two clauses that contain complementary literals (i.e., a literal and its negation)
-    *  and produces a new clause that is the union of the two clauses, excluding the complementary literals.
-    *
-    * @param first The first clause to be resolved.
-    * @param second The second clause to be resolved.
-    * @param target The literal on which the resolution should be performed.
-    * @return Clause The new clause resulting from the resolution operation.
+    * @struct Node
+    * Represents a node of the trie, reached by the literals on the path from the root.
     */
-    Clause resolve(const Clause& first, const Clause& second, const Literal& target) {
-        Clause result;
-        if (first.find(target) != first.end() && second.find(-target) != second.end()) {
-            for (const Literal& literal : first)
-                if (literal != target && literal != -target) result.insert(literal);
+    struct Node {
+        std::vector<std::pair<Literal, uint32_t>> children;  // sorted by the literal
+        uint32_t clauses = 0;                                 // clauses ending in the subtree
+        bool terminal = false;                                // a clause ends here
+    };
 
-            for (const Literal& literal : second)
-                if (literal != target && literal != -target) result.insert(literal);
-        }
+    std::vector<Node> nodes{ Node() };  // node 0 is the root
+    std::vector<uint32_t> released;
 
-        return result;
+    /**
+    * @brief Removes all clauses.
+    */
+    void clear() {
+        nodes.assign(1, Node());
+        released.clear();
     }
 
     /**
-    * @brief Parses a normal form representation from the given input stream.
-    *
-    * This function reads the normal form from the input stream, which should be in the DIMACS format.
-    * It skips any comment lines (starting with 'c') until it reaches the 'p' line,
-    *  which specifies the number of atoms and clauses in the formula.
-    *  It then reads the clauses and constructs the normal form.
-    *
-    * @param fin The input stream from which the normal form should be read.
-    * @return NormalForm The parsed normal form.
+    * @brief Returns the number of clauses in the trie.
     */
-    NormalForm parse(std::istream& fin) {
-        std::string buffer;
-        do {
-            fin >> buffer;
-            if(buffer == "c") fin.ignore(10000, '\n');
-        } while(buffer != "p");
+    size_t size() const {
+        return nodes[0].clauses;
+    }
 
-        // for "cnf"
-        fin >> buffer;
+    /**
+    * @brief Returns the number of nodes in use, the root included.
+    */
+    size_t nodeCount() const {
+        return nodes.size() - released.size();
+    }
 
-        int atomCount, clauseCount;
-        fin >> atomCount >> clauseCount;
+    /**
+    * @brief Returns the child of the node reached by the literal, or 0 if there is none.
+    */
+    uint32_t child(uint32_t node, Literal literal) const {
+        const auto& children = nodes[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), std::make_pair(literal, uint32_t(0)));
+        return it != children.end() && it->first == literal ? it->second : 0;
+    }
 
-        NormalForm formula;
-        for(int i = 0; i < clauseCount; i++) {
-            Clause c;
-            Literal l; fin >> l;
+    /**
+    * @brief Checks if the clause with the given sorted literals is in the trie.
+    */
+    template <typename Iterator>
+    bool contains(Iterator first, Iterator last) const {
+        uint32_t node = 0;
+        for (; first != last; ++first)
+            if (!(node = child(node, *first))) return false;
+        return nodes[node].terminal;
+    }
 
-            while(l != 0) {
-                literals.insert(l);
-                c.insert(l);
-                fin >> l;
-            }
+    /**
+    * @brief Adds the clause with the given sorted literals, if not already present.
+    *
+    * @return bool True if the clause was added, false if it was already present.
+    */
+    template <typename Iterator>
+    bool insert(Iterator first, Iterator last) {
+        if (contains(first, last)) return false;
 
-            formula.insert(c);
+        uint32_t node = 0;
+        nodes[node].clauses++;
+        for (; first != last; ++first) {
+            const Literal literal = *first;
+            uint32_t next = child(node, literal);
+            if (!next) {
+                if (!released.empty()) {
+                    next = released.back();
+                    released.pop_back();
+                } else {
+                    next = nodes.size();
+                    nodes.emplace_back();
+                }
+                auto& children = nodes[node].children;
+                children.insert(std::lower_bound(children.begin(), children.end(), std::make_pair(literal, uint32_t(0))),
+                                { literal, next });
+            }
+            node = next;
+            nodes[node].clauses++;
         }
-
-        return formula;
+        nodes[node].terminal = true;
+        return true;
     }
 
     /**
-    * @brief Computes the maximum occurrence count of each atom in the given normal form.
+    * @brief Removes the clause with the given sorted literals, if present, releasing the nodes only it used.
     *
-    * This function iterates through all clauses in the normal form and counts the number of occurrences of each atom.
-    * The result is a map that associates each atom with its maximum occurrence count in the formula.
-    *
-    * @param f The normal form for which the maximum occurrence counts should be computed.
-    * @return std::map<Atom, unsigned> A map that associates each atom with its maximum occurrence count.
+    * @return bool True if the clause was removed, false if it was not present.
     */
-    std::map<Atom, unsigned> maximumOccurrence(NormalForm& f) {
-        std::map<Atom, unsigned> occurrence;
-        for (const Clause& clause : f)
-            for (const Literal& literal : clause)
-                occurrence[ std::abs(literal) ]++;
+    template <typename Iterator>
+    bool erase(Iterator first, Iterator last) {
+        if (!contains(first, last)) return false;
 
-        return occurrence;
+        uint32_t node = 0;
+        for (; ; ++first) {
+            nodes[node].clauses--;
+            if (first == last) break;
+
+            auto& children = nodes[node].children;
+            auto it = std::lower_bound(children.begin(), children.end(), std::make_pair(*first, uint32_t(0)));
+            uint32_t next = it->second;
+            if (nodes[next].clauses == 1) {
+                // The rest of the path belongs to this clause only
+                children.erase(it);
+                while (true) {
+                    Node& freed = nodes[next];
+                    freed.clauses = 0;
+                    freed.terminal = false;
+                    released.push_back(next);
+                    if (freed.children.empty()) break;
+                    next = freed.children.front().second;
+                    freed.children.clear();
+                }
+                return true;
+            }
+            node = next;
+        }
+        nodes[node].terminal = false;
+        return true;
     }
 
     /**
-    * @brief Returns a vector of currently present atoms in random order.
+    * @brief Checks if some clause of the trie is a subset of the given clause, and so subsumes it.
     *
-    * This function iterates through currently present literals and extracts their atom representation.
-    * The result is a vector of atoms in random order.
+    * Children and literals are both sorted, so they are merged instead of looked up one by one.
     *
-    * @return std::vector<Atom> Random order of atoms currently present in the formula.
+    * @param first The pointer to the first of the sorted literals of the clause.
+    * @param count The number of literals.
+    * @return bool True if the clause is subsumed, false otherwise.
     */
-    std::vector<Atom> atomsRandomOrder() {
-        std::vector<bool> visited(literals.size() + 1, false);
-        std::vector<Atom> result;
-        for (const Literal& literal : literals) {
-            if (literal < 0 && !visited[-literal]) {
-                visited[-literal] = true;
-                result.push_back(-literal);
-            }
-            else if (literal > 0 && !visited[literal]) {
-                visited[literal] = true;
-                result.push_back(literal);
+    bool subsumes(const Literal* first, size_t count, uint32_t node = 0) const {
+        if (nodes[node].terminal) return true;
+
+        const auto& children = nodes[node].children;
+        auto it = children.begin();
+        for (size_t i = 0; i < count && it != children.end(); ) {
+            if (it->first < first[i]) ++it;
+            else if (first[i] < it->first) i++;
+            else {
+                if (subsumes(first + i + 1, count - i - 1, it->second)) return true;
+                ++it;
+                i++;
             }
         }
-
-        // Seed with a real random value, if available
-        std::random_device rd;
-        // Initialize a random number generator
-        std::mt19937 g(rd());
-
-        // Shuffle the vector
-        std::shuffle(result.begin(), result.end(), g);
-
-        return result;
+        return false;
     }
 
     /**
-    * @brief Recursively solves a Boolean satisfiability problem represented in normal form.
+    * @brief Finds the clauses of the trie which are supersets of the given clause, and so are subsumed by it.
     *
-    * @param f The normal form of the Boolean satisfiability problem to be solved.
-    * @return true if the problem is satisfiable, false otherwise.
+    * @param first The pointer to the first of the sorted literals of the clause.
+    * @param count The number of literals.
+    * @return std::vector<Clause> The subsumed clauses.
     */
-    bool solve(NormalForm& f) {
-        bool conflict;
-
-        // Remove all possible variables
-        // Choose variables to remove using the maximum occurrence heuristic
-        std::map<Atom, unsigned> occurrence = maximumOccurrence(f);
-        for (auto it = occurrence.rbegin(); it != occurrence.rend(); ++it) {
-            // 1. Remove tautology clauses
-            removeAllTautologyClauses(f);
+    std::vector<Clause> subsumedBy(const Literal* first, size_t count) const {
+        std::vector<Clause> result;
+        std::vector<Literal> path;
+        collectSupersets(0, first, count, path, result);
+        return result;
+    }
 
-            // 2. Remove unit clauses
-            removeUnitClauses(f, conflict);
-            if (conflict) return false;  // UNSAT - empty clause
+    /**
+    * @brief Collects the clauses below the node which contain the given literals, given the literals on the path to it.
+    */
+    void collectSupersets(uint32_t node, const Literal* first, size_t count, std::vector<Literal>& path, std::vector<Clause>& result) const {
+        if (count == 0 && nodes[node].terminal) result.emplace_back(path.begin(), path.end());
 
-            // 3. Remove pure clausese
-            removePureClauses(f);
+        for (const auto& [literal, next] : nodes[node].children) {
+            if (count > 0 && first[0] < literal) break;  // the next literal cannot occur any more
+            path.push_back(literal);
+            if (count > 0 && literal == first[0]) collectSupersets(next, first + 1, count - 1, path, result);
+            else collectSupersets(next, first, count, path, result);
+            path.pop_back();
+        }
+    }
+};
 
-            // 4. Check if formula is SAT or UNSAT
-            if (f.empty()) return true;  // SAT - formula is empty
-            if (f.size() == 1 && f.begin()->empty()) return false;  // UNSAT - empty clause
+/**
+* @struct DP
+* Represents a data structure used for processing and manipulating logical formulas in conjunctive normal form (CNF).
+*
+* This struct maintains sets of literals, including the set of all literals and the set of false literals.
+* It provides various methods for analyzing and modifying the normal form of the formula.
+*/
+struct DP {
+    /**
+    * @struct TrailEntry
+    * Records a single change of the formula or of the set of false literals, so that it can be undone.
+    *
+    * An erased clause is kept in the node taken out of the formula, so neither recording nor undoing it copies
+    *  the clause, and an inserted clause is referred to by its address in the formula, which the node keeps.
+    */
+    struct TrailEntry {
+        enum Kind { InsertClause, EraseClause, AddFalseLiteral };
+
+        Kind kind;
+        NormalForm::node_type erased;
+        const Clause* inserted;
+        Literal literal;
+    };
+
+    std::set<Literal> literals;
+    std::set<Literal> falseLiterals;
+
+    // Changes made by the simplification passes while recording is enabled
+    std::vector<TrailEntry> trail;
+    bool recording = false;
+
+    // Resolvents of the variable currently being eliminated, in narrow batches when every atom of the formula fits
+    ResolventBatch resolvents;
+    NarrowResolventBatch narrowResolvents;
+    bool narrow = false;
+
+    // Upper bound for the number of atoms reserved up front from the header
+    static constexpr size_t maxReserved = 1 << 24;
+
+    // Counts declared by the header and the largest atom actually read
+    int atomCount = 0;
+    int clauseCount = 0;
+    Atom maxAtom = 0;
+    bool preallocate = true;
+
+    // Values of the atoms forced by unit clauses read so far (1 true, -1 false, 0 unknown)
+    std::vector<signed char> unitValues;
+    bool propagateOnParse = false;
+    bool validateInput = false;
+    bool parseConflict = false;
+    bool headerlessWeighted = false;    // a formula without a header is weighted, with hard clauses starting with 'h'
+    bool parseError = false;
+
+    // Knobs of the elimination: the order of the atoms and the largest growth of the formula per atom
+    bool randomOrder = false;
+    size_t eliminationBound = SIZE_MAX;
+
+    /**
+    * @struct Pass
+    * Represents the schedule of a simplification pass of solve: its effort, its payoff and when it runs next.
+    */
+    struct Pass {
+        double share;               // part of the elimination effort the pass may spend
+        uint64_t effort = 0;        // clauses and atoms examined so far
+        uint64_t payoff = 0;        // clauses removed so far
+        uint64_t runs = 0;
+        unsigned interval = 1;      // iterations between runs, growing while the pass achieves nothing
+        unsigned wait = 0;
+    };
+
+    // Result of a slice of solving
+    enum Progress { Running, Satisfiable, Unsatisfiable };
+
+    // Position of the elimination, so that it can be suspended between atoms and resumed
+    std::vector<Atom> eliminationOrder;
+    size_t orderPosition = 0;
+    bool eliminatedThisRound = true;
+
+    // Simplification passes of solve, which only look at what changed since they last ran
+    static constexpr uint64_t passBaseBudget = 1 << 16;
+    bool scheduling = false;
+    Pass tautologyPass{ 0.05 }, unitPass{ 1.0 }, purePass{ 0.25 };
+    uint64_t eliminationEffort = 0;
+    uint64_t erasedClauses = 0;
+    std::vector<Clause> pendingTautologies;
+    std::vector<Literal> pendingUnits;
+    std::vector<Atom> dirtyAtoms;            // atoms which lost occurrences, so they may have become pure
+    std::vector<char> dirty;
+    std::vector<size_t> occurrences;         // occurrences of every literal, indexed by literalIndex
+
+    // Clauses containing every literal, indexed by literalIndex. Erased clauses are dropped lazily,
+    //  so an entry is only followed if its clause is still live and still contains the literal.
+    std::vector<std::vector<const Clause*>> occurrenceLists;
+    std::unordered_set<const Clause*> liveClauses;
+
+    // Index of the clauses while solving, used to drop subsumed resolvents and the clauses resolvents subsume
+    bool subsumption = true;
+    ClauseTrie trie;
+    size_t subsumedResolvents = 0;
+    size_t subsumedClauses = 0;
+
+    // Soft clauses of a weighted formula, which are kept out of the normal form of the hard clauses
+    bool weighted = false;
+    uint64_t top = UINT64_MAX;
+    std::vector<std::pair<Clause, uint64_t>> softClauses;
+
+    /**
+    * @brief Removes the clause the iterator points to and records the change on the trail.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param it The iterator pointing to the clause to be removed.
+    * @return NormalForm::iterator The iterator following the removed clause.
+    */
+    NormalForm::iterator eraseClause(NormalForm& f, NormalForm::iterator it) {
+        if (scheduling) noteErased(*it);
+        if (!recording) return f.erase(it);
+        auto next = std::next(it);
+        trail.push_back({ TrailEntry::EraseClause, f.extract(it), nullptr, 0 });
+        return next;
+    }
+
+    /**
+    * @brief Removes the given clause, if present, and records the change on the trail.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param clause The clause to be removed.
+    */
+    void eraseClause(NormalForm& f, const Clause& clause) {
+        auto it = f.find(clause);
+        if (it != f.end()) eraseClause(f, it);
+    }
+
+    /**
+    * @brief Adds the given clause, which must not be present, next to the hint and records the change on the trail.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param hint The iterator to the first clause greater than the one being added.
+    * @param clause The clause to be added.
+    * @return NormalForm::iterator The iterator pointing to the added clause.
+    */
+    NormalForm::iterator insertClause(NormalForm& f, NormalForm::iterator hint, Clause clause) {
+        auto it = f.emplace_hint(hint, std::move(clause));
+        if (recording) trail.push_back({ TrailEntry::InsertClause, {}, &*it, 0 });
+        if (scheduling) noteInserted(*it);
+        return it;
+    }
+
+    /**
+    * @brief Adds the given clause, if not already present, and records the change on the trail.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param clause The clause to be added.
+    * @return bool True if the clause was added, false if it was already present.
+    */
+    bool insertClause(NormalForm& f, const Clause& clause) {
+        const auto [it, added] = f.insert(clause);
+        if (!added) return false;
+        if (recording) trail.push_back({ TrailEntry::InsertClause, {}, &*it, 0 });
+        if (scheduling) noteInserted(*it);
+        return true;
+    }
+
+    /**
+    * @brief Marks the given literal as false and records the change on the trail.
+    *
+    * @param literal The literal which becomes false.
+    */
+    void addFalseLiteral(const Literal& literal) {
+        if (falseLiterals.insert(literal).second && recording)
+            trail.push_back({ TrailEntry::AddFalseLiteral, {}, nullptr, literal });
+    }
+
+    /**
+    * @brief Returns the index of the literal in the per-literal arrays.
+    */
+    static size_t literalIndex(const Literal& literal) {
+        return 2 * static_cast<size_t>(std::abs(literal)) + (literal < 0);
+    }
+
+    /**
+    * @brief Updates the occurrences, the work of the passes and the clause trie for a clause added while solving.
+    *
+    * @param clause The clause, as stored in the formula.
+    */
+    void noteInserted(const Clause& clause) {
+        if (subsumption) trie.insert(clause.begin(), clause.end());
+        liveClauses.insert(&clause);
+        for (const Literal& literal : clause) {
+            const size_t index = literalIndex(literal);
+            if (index >= occurrences.size()) {
+                occurrences.resize(2 * index + 2, 0);
+                occurrenceLists.resize(2 * index + 2);
+                dirty.resize(index + 1, false);
+            }
+            occurrences[index]++;
+            occurrenceLists[index].push_back(&clause);
+            if (occurrenceLists[index].size() > 2 * occurrences[index] + 16) clausesContaining(literal);
+        }
+
+        if (clause.size() == 1) pendingUnits.push_back(*clause.begin());
+        for (auto it = clause.begin(); it != clause.end() && *it < 0; ++it)
+            if (clause.count(-*it)) {
+                pendingTautologies.push_back(clause);
+                break;
+            }
+    }
+
+    /**
+    * @brief Updates the occurrences, the work of the passes and the clause trie for a clause removed while solving.
+    */
+    void noteErased(const Clause& clause) {
+        if (subsumption) trie.erase(clause.begin(), clause.end());
+        liveClauses.erase(&clause);
+        erasedClauses++;
+        for (const Literal& literal : clause) {
+            occurrences[literalIndex(literal)]--;
+            const Atom atom = std::abs(literal);
+            if (!dirty[atom]) {
+                dirty[atom] = true;
+                dirtyAtoms.push_back(atom);
+            }
+        }
+    }
+
+    /**
+    * @brief Returns the clauses of the formula containing the literal, while solving.
+    *
+    * The occurrence list of the literal is pruned of erased clauses and duplicates on the way,
+    *  so its length stays proportional to the occurrences of the literal.
+    *
+    * @param literal The literal.
+    * @return std::vector<const Clause*> The clauses containing the literal.
+    */
+    std::vector<const Clause*> clausesContaining(const Literal& literal) {
+        const size_t index = literalIndex(literal);
+        if (index >= occurrenceLists.size()) return {};
+        std::vector<const Clause*>& list = occurrenceLists[index];
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        list.erase(std::remove_if(list.begin(), list.end(), [&](const Clause* clause) {
+            return liveClauses.count(clause) == 0 || clause->count(literal) == 0;
+        }), list.end());
+        return list;
+    }
+
+    /**
+    * @brief Removes the given literals, which just became false, from the clauses containing them while solving.
+    *
+    * Clauses reduced to a single literal make its negation false as well, which is removed in turn.
+    *  Only the clauses in the occurrence lists of these literals are visited, not the whole formula.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param queue The literals which became false.
+    * @param conflict Bool value that becomes yes if a clause becomes empty.
+    * @return size_t The number of clauses visited.
+    */
+    size_t removeFalseLiterals(NormalForm& f, std::vector<Literal> queue, bool& conflict) {
+        size_t visited = 0;
+        while (!queue.empty()) {
+            const Literal falseLiteral = queue.back();
+            queue.pop_back();
+            for (const Clause* clause : clausesContaining(falseLiteral)) {
+                if (liveClauses.count(clause) == 0) continue;   // erased as a clause visited before
+                visited++;
+                Clause newClause;
+                for (const Literal& literal : *clause)
+                    if (falseLiterals.find(literal) == falseLiterals.end()) newClause.insert(literal);
+                if (newClause.empty()) {
+                    conflict = true;
+                    return visited;  // UNSAT - empty clause
+                }
+
+                eraseClause(f, f.find(*clause));
+                if (isUnitClause(newClause)) {
+                    const Literal unit = *newClause.begin();
+                    if (falseLiterals.find(-unit) == falseLiterals.end()) {
+                        addFalseLiteral(-unit);
+                        queue.push_back(-unit);
+                    }
+                }
+                else insertClause(f, newClause);
+            }
+        }
+        return visited;
+    }
+
+    /**
+    * @brief Returns the current position of the trail.
+    *
+    * @return size_t The mark which can later be passed to undo().
+    */
+    size_t trailMark() const {
+        return trail.size();
+    }
+
+    /**
+    * @brief Rolls back all changes recorded on the trail after the given mark.
+    *
+    * The time needed is proportional to the number of recorded changes, not to the size of the formula.
+    *  While solving, the changes are undone through the same bookkeeping as the changes themselves, so the
+    *  occurrences, the work of the passes and the clause trie keep matching the formula.
+    *
+    * @param f The normal form of the formula, which will be restored.
+    * @param mark The position of the trail returned by trailMark().
+    */
+    void undo(NormalForm& f, size_t mark) {
+        while (trail.size() > mark) {
+            TrailEntry& entry = trail.back();
+            switch (entry.kind) {
+                case TrailEntry::InsertClause: {
+                    auto it = f.find(*entry.inserted);
+                    if (scheduling) noteErased(*it);
+                    f.erase(it);
+                    break;
+                }
+                case TrailEntry::EraseClause: {
+                    auto it = f.insert(std::move(entry.erased)).position;
+                    if (scheduling) noteInserted(*it);
+                    break;
+                }
+                case TrailEntry::AddFalseLiteral: falseLiterals.erase(entry.literal); break;
+            }
+            trail.pop_back();
+        }
+    }
+
+    /**
+    * @brief Prints the given normal form of the formula.
+    *
+    * @param f The normal form of the formula to be printed.
+    */
+    void print(const NormalForm& f) {
+        for (const Clause& clause : f) {
+            std::cout << "[ ";
+            for (const Literal& literal : clause)
+                std::cout << literal << " ";
+            std::cout << "]";
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+    * @brief Checks if a given clause is tautological.
+    *
+    * Clause is tautological if it contains both a literal and its negation.
+    *
+    * @param clause The clause to be checked.
+    * @return bool True if the clause is tautological, false otherwise.
+    */
+    bool isTautologicClause(const Clause& clause) {
+        std::set<Literal> seenLiterals;
+        for (const Literal& literal : clause) {
+            if (seenLiterals.find(-literal) != seenLiterals.end()) return true;
+            seenLiterals.insert(literal);
+        }
+
+        return false;
+    }
+
+    /**
+    * @brief Removes all tautological clauses from the given normal form.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    */
+    void removeAllTautologyClauses(NormalForm& f) {
+        for (auto it = f.begin(); it != f.end(); )
+            if (isTautologicClause(*it)) it = eraseClause(f, it);
+            else ++it;
+    }
+
+    /**
+    * @brief Checks if a given clause is a unit clause, meaning it contains only one literal.
+    *
+    * @param clause The clause to be checked.
+    * @return bool True if the clause is a unit clause, false otherwise.
+    */
+    bool isUnitClause(const Clause& clause) {
+        return clause.size() == 1;
+    }
+
+    /**
+    * @brief Removes all false literals from the clauses in the given normal form.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param conflict Bool value that becomes yes if the clause becomes empty.
+    */
+    void removeFalseLiterals(NormalForm& f, bool& conflict) {
+        for (auto it = f.begin(); it != f.end(); ) {
+            bool clauseModified = false;
+            Clause newClause;
+            for (const Literal& literal : *it)
+                if (falseLiterals.find(literal) != falseLiterals.end()) clauseModified = true;
+                else newClause.insert(literal);
+
+            if (clauseModified) {
+                if (newClause.empty()) {
+                    conflict = true;
+                    return;  // UNSAT - empty clause
+                }
+
+                it = eraseClause(f, it);
+                if (!newClause.empty()) {
+                    if (isUnitClause(newClause)) {
+                        addFalseLiteral(-(*newClause.begin()));
+                        it = f.begin(); // potentially remove newly unlocked false literals
+                    }
+                    else insertClause(f, newClause);
+                }
+            }
+            else ++it;
+        }
+    }
+
+    /**
+    * @brief Removes all unit clauses from the given normal form and updates the set of false literals accordingly.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param conflict Bool value that becomes yes if there are conflict clauses.
+    */
+    void removeUnitClauses(NormalForm& f, bool& conflict) {
+        for (auto it = f.begin(); it != f.end(); ) {
+            if (isUnitClause(*it)) {
+                Literal unitLiteral = *it->begin();
+                if (falseLiterals.find(unitLiteral) != falseLiterals.end()) {
+                    conflict = true;
+                    return;  // UNSAT - conflict clauses
+                }
+
+                addFalseLiteral(-unitLiteral);
+                it = eraseClause(f, it);
+            }
+            else ++it;
+        }
+
+        if (!falseLiterals.empty())
+            removeFalseLiterals(f, conflict);
+    }
+
+    /**
+    * @brief Checks if a given literal is a pure literal.
+    *
+    * A pure literal is a literal that appears only with one sign (either positive or negative) in the entire formula.
+    * This function iterates through all clauses and checks if they contain pure literals.
+    *
+    * @param literal The literal to be checked.
+    * @param f The normal form of the formula.
+    * @return bool True if the literal is a pure literal, false otherwise.
+    */
+    bool isPureLiteral(const Literal& literal, const NormalForm& f) {
+        for (const Clause& clause : f)
+            if (clause.find(-literal) != clause.end()) return false;
+
+        return true;
+    }
+
+    /**
+    * @brief Removes all clauses containing the given pure literal from the normal form.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param pureLiteral The pure literal to be removed.
+    */
+    void removePureClausesByLiteral(NormalForm& f, const Literal& pureLiteral) {
+        for (auto it = f.begin(); it != f.end(); )
+            if (it->find(pureLiteral) != it->end()) it = eraseClause(f, it);
+            else ++it;
+    }
+
+    /**
+    * @brief Removes pure clauses from the given normal form.
+    *
+    * This function iterates through all literals and removes the clauses containing the pure literals.
+    *
+    * @param f The normal form from which the pure clauses should be removed.
+    */
+    void removePureClauses(NormalForm& f) {
+        for (const Literal& literal : literals)
+            if (isPureLiteral(literal, f))
+                removePureClausesByLiteral(f, literal);
+    }
+
+    /**
+    * @brief Tentatively assumes the literal, simplifies the formula and rolls all the changes back.
+    *
+    * The literal is added as a unit clause and unit propagation is applied, optionally followed by pure literal removal.
+    *  The changes are recorded on the trail and undone before returning, so the formula is never copied.
+    *
+    * @param f The normal form of the formula, which is restored before returning.
+    * @param literal The literal assumed to be true.
+    * @param implied Filled with the literals which became true by unit propagation.
+    * @param pureLiterals True if the pure literal removal should be applied as well.
+    * @return bool True if the assumption leads to a conflict, false otherwise.
+    */
+    bool probe(NormalForm& f, const Literal& literal, std::vector<Literal>& implied, bool pureLiterals = false) {
+        implied.clear();
+        if (falseLiterals.find(literal) != falseLiterals.end()) return true;
+
+        const size_t mark = trailMark();
+        const bool wasRecording = recording;
+        recording = true;
+
+        bool conflict = false;
+        insertClause(f, Clause{ literal });
+        removeUnitClauses(f, conflict);
+        if (!conflict && pureLiterals) removePureClauses(f);
+
+        for (size_t i = mark; i < trail.size(); i++)
+            if (trail[i].kind == TrailEntry::AddFalseLiteral) implied.push_back(-trail[i].literal);
+
+        undo(f, mark);
+        recording = wasRecording;
+        return conflict;
+    }
+
+    /**
+    * @brief Retrieves all clauses in the given normal form that contain the specified literal.
+    *
+    * This function iterates through all clauses in the normal form and adds the clauses that contain the target literal to the result vector.
+    *
+    * @param f The normal form to search through.
+    * @param target The literal to search for in the clauses.
+    * @return std::vector<Clause> A vector containing all clauses that include the target literal.
+    */
+    std::vector<Clause> allClausesWithGivenLiteral(const NormalForm& f, const Literal& target) {
+        std::vector<Clause> result;
+        for (const auto& clause : f)
+            if (clause.find(target) != clause.end()) result.push_back(clause);
+
+        return result;
+    }
+
+    /**
+    * @brief Resolves two clauses on a given literal, producing a new clause.
+    *
+    * The resolution operation is a fundamental inference rule in propositional logic.
+    *  It takes two clauses that contain complementary literals (i.e., a literal and its negation)
+    *  and produces a new clause that is the union of the two clauses, excluding the complementary literals.
+    *
+    * @param first The first clause to be resolved.
+    * @param second The second clause to be resolved.
+    * @param target The literal on which the resolution should be performed.
+    * @return Clause The new clause resulting from the resolution operation.
+    */
+    Clause resolve(const Clause& first, const Clause& second, const Literal& target) {
+        Clause result;
+        if (first.find(target) != first.end() && second.find(-target) != second.end()) {
+            for (const Literal& literal : first)
+                if (literal != target && literal != -target) result.insert(literal);
+
+            for (const Literal& literal : second)
+                if (literal != target && literal != -target) result.insert(literal);
+        }
+
+        return result;
+    }
+
+    /**
+    * @brief Resolves every clause containing the literal with every clause containing its negation into the batch.
+    *
+    * @param batch The batch, which is cleared first.
+    * @param clausesWith The clauses containing the literal.
+    * @param clausesWithout The clauses containing the negation of the literal.
+    * @param literal The literal on which the resolution is performed.
+    * @return bool False if an empty resolvent was produced, true otherwise.
+    */
+    template <typename Batch>
+    bool collectResolvents(Batch& batch, const std::vector<Clause>& clausesWith, const std::vector<Clause>& clausesWithout,
+                           const Literal& literal) {
+        batch.clear();
+        for (const Clause& clause1 : clausesWith)
+            for (const Clause& clause2 : clausesWithout)
+                if (batch.addResolvent(clause1, clause2, literal) && batch.length(batch.size() - 1) == 0) return false;
+        return true;
+    }
+
+    /**
+    * @brief Merges a batch of resolvents into the given normal form.
+    *
+    * The batch is deduplicated at once, so a clause is built and looked up in the normal form only for distinct resolvents.
+    *  While solving with subsumption, resolvents subsumed by a clause of the formula are dropped and the clauses
+    *  a resolvent subsumes are removed, both found in the clause trie.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @param batch The batch of resolvents, none of which is empty or tautological.
+    * @return std::vector<Literal> The literals of the unit resolvents.
+    */
+    template <typename Batch>
+    std::vector<Literal> mergeResolvents(NormalForm& f, const Batch& batch) {
+        std::vector<Literal> units;
+        std::vector<Literal> buffer;
+        for (size_t index : batch.deduplicate()) {
+            const Literal* first = batch.decode(index, buffer);
+            if (batch.length(index) == 1) units.push_back(*first);
+
+            if (scheduling && subsumption) {
+                if (trie.subsumes(first, batch.length(index))) {
+                    subsumedResolvents++;
+                    continue;
+                }
+                for (const Clause& subsumed : trie.subsumedBy(first, batch.length(index))) {
+                    eraseClause(f, subsumed);
+                    subsumedClauses++;
+                }
+            }
+
+            Clause clause(first, first + batch.length(index));
+            auto position = f.lower_bound(clause);
+            if (position == f.end() || *position != clause) insertClause(f, position, std::move(clause));
+        }
+
+        return units;
+    }
+
+    /**
+    * @brief Adds a clause read by the parser to the formula, keeping track of the unit clauses read so far.
+    *
+    * A unit clause whose negation was already read is a conflict. If propagation during parsing is enabled,
+    *  clauses satisfied by the units read so far are dropped and their false literals are removed, which may produce new units.
+    *
+    * @param f The normal form being parsed, which will be modified.
+    * @param clauseLiterals The sorted, distinct literals of the clause, which may be modified.
+    * @return bool False if the clause contradicts the units read so far, true otherwise.
+    */
+    bool addParsedClause(NormalForm& f, std::vector<Literal>& clauseLiterals) {
+        auto value = [this](const Literal& literal) -> int {
+            const size_t atom = std::abs(literal);
+            if (atom >= unitValues.size()) return 0;
+            return literal > 0 ? unitValues[atom] : -unitValues[atom];
+        };
+
+        if (propagateOnParse) {
+            size_t kept = 0;
+            for (const Literal& literal : clauseLiterals) {
+                if (value(literal) > 0) return true;  // satisfied by a unit clause
+                if (value(literal) == 0) clauseLiterals[kept++] = literal;
+            }
+            clauseLiterals.resize(kept);
+            if (clauseLiterals.empty()) return false;  // UNSAT - all literals are false
+        }
+
+        if (clauseLiterals.size() == 1) {
+            const Literal unit = clauseLiterals.front();
+            if (value(unit) < 0) return false;  // UNSAT - complementary unit clauses
+
+            const size_t atom = std::abs(unit);
+            if (atom >= unitValues.size()) unitValues.resize(std::max(atom + 1, unitValues.capacity()), 0);
+            unitValues[atom] = unit > 0 ? 1 : -1;
+        }
+
+        f.emplace(clauseLiterals.begin(), clauseLiterals.end());
+        return true;
+    }
+
+    /**
+    * @brief Parses a normal form representation from the given input stream.
+    *
+    * This function reads the normal form from the input stream, which should be in the DIMACS format.
+    * It skips any comment lines (starting with 'c') until it reaches the 'p' line,
+    *  which specifies the number of atoms and clauses in the formula.
+    *  It then reads the clauses and constructs the normal form.
+    *
+    * The counts from the header are used to reserve the per-literal structures, which grow if the header turns out to be wrong.
+    *  Literals of a clause are collected into a reusable buffer and sorted, so the clause is built in linear time.
+    *  Reading stops as soon as complementary unit clauses are found, unless the whole input should be validated.
+    *
+    * A formula without a header is read clause by clause until the end of the input.
+    *
+    * Weighted formulas are accepted as well, either with a 'p wcnf' header, where clauses weighing at least
+    *  the top weight are hard, or without a header if headerlessWeighted is set, where hard clauses start with 'h'.
+    *  Their soft clauses are stored in softClauses and only the hard clauses make up the returned normal form.
+    *  A clause starting with 'h' in any other formula is reported and sets parseError.
+    *
+    * @param fin The input stream from which the normal form should be read.
+    * @return NormalForm The parsed normal form.
+    */
+    NormalForm parse(std::istream& fin) {
+        std::string buffer;
+        do {
+            fin >> buffer;
+            if(buffer == "c") fin.ignore(10000, '\n');
+        } while(buffer != "p" && buffer != "h" && buffer[0] != '-' && !std::isdigit(static_cast<unsigned char>(buffer[0])) && fin);
+
+        // A formula without a header starts directly with its first clause
+        const bool headerless = fin && buffer != "p";
+        if (headerless) {
+            weighted = headerlessWeighted;
+            if (buffer == "h" && !weighted) {
+                std::cerr << "Error: a clause starts with 'h', but the formula has no 'p wcnf' header; use --wcnf" << std::endl;
+                parseError = true;
+                return NormalForm();
+            }
+        }
+        else {
+            // for "cnf" or "wcnf"
+            fin >> buffer;
+            weighted = buffer == "wcnf";
+            fin >> atomCount >> clauseCount;
+            if (weighted) {
+                std::string rest;
+                std::getline(fin, rest);
+                std::istringstream(rest) >> top;
+            }
+        }
+
+        // Reserve the per-literal structures up front, without trusting an absurd header
+        std::vector<bool> seen;
+        std::vector<Literal> clauseLiterals;
+        if (preallocate) {
+            seen.reserve(2 * (std::min<size_t>(std::max(atomCount, 0), maxReserved) + 1));
+            unitValues.reserve(std::min<size_t>(std::max(atomCount, 0), maxReserved) + 1);
+            clauseLiterals.reserve(std::min<size_t>(std::max(atomCount, 0), 1024));
+        }
+
+        NormalForm formula;
+        int clausesRead = 0;
+        bool pending = headerless;   // the first token was already read while looking for the header
+        for(int i = 0; headerless || i < clauseCount; i++) {
+            clauseLiterals.clear();
+            Literal l;
+
+            bool hard = true;
+            uint64_t weight = 0;
+            if (weighted) {
+                if (!pending && !(fin >> buffer)) break;
+                pending = false;
+                if (buffer == "c") {
+                    fin.ignore(10000, '\n');
+                    i--;
+                    continue;
+                }
+                if (buffer != "h") {
+                    weight = std::strtoull(buffer.c_str(), nullptr, 10);
+                    hard = !headerless && weight >= top;
+                }
+            }
+
+            auto addLiteral = [&](Literal literal) {
+                if (parseConflict) return;  // only validating the rest of the input
+
+                const size_t index = 2 * static_cast<size_t>(std::abs(literal)) + (literal < 0);
+                if (index >= seen.size()) seen.resize(std::max(index + 1, seen.capacity()), false);
+                if (!seen[index]) {
+                    seen[index] = true;
+                    literals.insert(literal);
+                    maxAtom = std::max(maxAtom, std::abs(literal));
+                }
+                clauseLiterals.push_back(literal);
+            };
+
+            // The first literal of a formula without a header was already read
+            bool ended = false;
+            if (pending) {
+                pending = false;
+                l = std::atoi(buffer.c_str());
+                if (l != 0) addLiteral(l);
+                else ended = true;
+            }
+            while(!ended && fin >> l && l != 0) addLiteral(l);
+
+            // The header promised more clauses than there are
+            if (!fin && clauseLiterals.empty()) break;
+            clausesRead++;
+            if (parseConflict) continue;
+
+            std::sort(clauseLiterals.begin(), clauseLiterals.end());
+            clauseLiterals.erase(std::unique(clauseLiterals.begin(), clauseLiterals.end()), clauseLiterals.end());
+            if (!hard) {
+                if (weight > 0) softClauses.emplace_back(Clause(clauseLiterals.begin(), clauseLiterals.end()), weight);
+                continue;
+            }
+            if (!addParsedClause(formula, clauseLiterals)) {
+                formula.insert(Clause());
+                parseConflict = true;
+                if (!validateInput) return formula;  // UNSAT - no need to read the rest
+            }
+        }
+
+        if (validateInput && !headerless && clausesRead != clauseCount)
+            std::cerr << "Warning: header declares " << clauseCount << " clauses, but " << clausesRead << " were read" << std::endl;
+        if (validateInput && maxAtom > atomCount)
+            std::cerr << "Warning: header declares " << atomCount << " atoms, but atom " << maxAtom << " was read" << std::endl;
+
+        return formula;
+    }
+
+    /**
+    * @brief Computes the maximum occurrence count of each atom in the given normal form.
+    *
+    * This function iterates through all clauses in the normal form and counts the number of occurrences of each atom.
+    * The result is a map that associates each atom with its maximum occurrence count in the formula.
+    *
+    * @param f The normal form for which the maximum occurrence counts should be computed.
+    * @return std::map<Atom, unsigned> A map that associates each atom with its maximum occurrence count.
+    */
+    std::map<Atom, unsigned> maximumOccurrence(NormalForm& f) {
+        std::map<Atom, unsigned> occurrence;
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause)
+                occurrence[ std::abs(literal) ]++;
+
+        return occurrence;
+    }
+
+    /**
+    * @brief Returns a vector of currently present atoms in random order.
+    *
+    * This function iterates through currently present literals and extracts their atom representation.
+    * The result is a vector of atoms in random order.
+    *
+    * @return std::vector<Atom> Random order of atoms currently present in the formula.
+    */
+    std::vector<Atom> atomsRandomOrder() {
+        const Atom largest = literals.empty() ? 0 : std::max(-*literals.begin(), *literals.rbegin());
+        std::vector<bool> visited(largest + 1, false);
+        std::vector<Atom> result;
+        for (const Literal& literal : literals) {
+            if (literal < 0 && !visited[-literal]) {
+                visited[-literal] = true;
+                result.push_back(-literal);
+            }
+            else if (literal > 0 && !visited[literal]) {
+                visited[literal] = true;
+                result.push_back(literal);
+            }
+        }
+
+        // Seed with a real random value, if available
+        std::random_device rd;
+        // Initialize a random number generator
+        std::mt19937 g(rd());
+
+        // Shuffle the vector
+        std::shuffle(result.begin(), result.end(), g);
+
+        return result;
+    }
+
+    /**
+    * @brief Checks if a pass should run now, which needs pending work, its turn and enough budget.
+    *
+    * The budget of a pass is a share of the effort spent by elimination, so cheap passes run often
+    *  on formulas where elimination is expensive and rarely on formulas where it is cheap.
+    */
+    bool due(Pass& pass, bool pending) {
+        if (!pending) return false;
+        if (pass.wait > 0) {
+            pass.wait--;
+            return false;
+        }
+        return pass.effort <= pass.share * eliminationEffort + passBaseBudget;
+    }
+
+    /**
+    * @brief Records a run of the pass and schedules the next one, sooner if the run paid off and later if it did not.
+    */
+    void reschedule(Pass& pass, uint64_t effort, uint64_t payoff) {
+        pass.runs++;
+        pass.effort += effort;
+        pass.payoff += payoff;
+        pass.interval = payoff > 0 ? std::max(1u, pass.interval / 2) : std::min(64u, pass.interval * 2);
+        pass.wait = pass.interval - 1;
+    }
+
+    /**
+    * @brief Runs the simplification passes which are due, each on the clauses and atoms touched since its last run.
+    *
+    * Tautologies can only come from added clauses and new unit clauses only from added clauses as well,
+    *  while an atom can only become pure by losing occurrences, so these are all the passes have to look at.
+    *  The clauses with a literal which became false or pure are found in the occurrence lists, and the effort
+    *  of a pass counts the clauses it actually visited.
+    *
+    * @param f The normal form of the formula, which will be modified.
+    * @return bool False if a conflict was found, true otherwise.
+    */
+    bool runPasses(NormalForm& f) {
+        // 1. Remove tautology clauses
+        if (due(tautologyPass, !pendingTautologies.empty())) {
+            const uint64_t erased = erasedClauses;
+            for (const Clause& clause : pendingTautologies) eraseClause(f, clause);
+            reschedule(tautologyPass, pendingTautologies.size(), erasedClauses - erased);
+            pendingTautologies.clear();
+        }
+
+        // 2. Remove unit clauses
+        if (due(unitPass, !pendingUnits.empty())) {
+            const uint64_t erased = erasedClauses;
+            std::vector<Literal> units, newlyFalse;
+            units.swap(pendingUnits);
+            for (const Literal& unit : units) {
+                auto it = f.find(Clause{ unit });
+                if (it == f.end()) continue;
+                if (falseLiterals.count(unit)) return false;  // UNSAT - conflict clauses
+                if (!falseLiterals.count(-unit)) {
+                    addFalseLiteral(-unit);
+                    newlyFalse.push_back(-unit);
+                }
+                eraseClause(f, it);
+            }
+
+            bool conflict = false;
+            const size_t visited = removeFalseLiterals(f, std::move(newlyFalse), conflict);
+            if (conflict) return false;  // UNSAT - empty clause
+            reschedule(unitPass, units.size() + visited, erasedClauses - erased);
+        }
+
+        // 3. Remove pure clauses
+        if (due(purePass, !dirtyAtoms.empty())) {
+            const uint64_t erased = erasedClauses;
+            std::vector<Atom> atoms;
+            atoms.swap(dirtyAtoms);
+
+            std::vector<Literal> pure;
+            for (const Atom& atom : atoms) {
+                dirty[atom] = false;
+                const size_t positive = occurrences[literalIndex(atom)], negative = occurrences[literalIndex(-atom)];
+                if (positive > 0 && negative == 0) pure.push_back(atom);
+                else if (negative > 0 && positive == 0) pure.push_back(-atom);
+            }
+
+            size_t visited = 0;
+            for (const Literal& literal : pure)
+                for (const Clause* clause : clausesContaining(literal)) {
+                    if (liveClauses.count(clause) == 0) continue;   // contained an earlier pure literal too
+                    visited++;
+                    eraseClause(f, f.find(*clause));
+                }
+            reschedule(purePass, atoms.size() + visited, erasedClauses - erased);
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief Solves a Boolean satisfiability problem represented in normal form.
+    *
+    * The formula is simplified once completely, and from then on the simplification passes are scheduled
+    *  by eliminate() according to what changed, their budgets and their payoff. The clause trie follows
+    *  every change of the formula, so that resolvents can be checked for subsumption. Resolution never
+    *  introduces atoms, so if every atom fits into 16 bits now, all resolvents use narrow batches.
+    *
+    * @param f The normal form of the Boolean satisfiability problem to be solved.
+    * @return true if the problem is satisfiable, false otherwise.
+    */
+    bool solve(NormalForm& f) {
+        startSolving(f);
+        return eliminate(f, UINT64_MAX) == Satisfiable;
+    }
+
+    /**
+    * @brief Prepares solving the formula in slices: simplifies it once completely and sets up the passes.
+    *
+    * @param f The normal form of the Boolean satisfiability problem to be solved.
+    */
+    void startSolving(NormalForm& f) {
+        removeAllTautologyClauses(f);
+
+        occurrences.assign(2 * (maxAtom + 1), 0);
+        occurrenceLists.assign(2 * (maxAtom + 1), {});
+        liveClauses.clear();
+        dirty.assign(maxAtom + 1, false);
+        pendingTautologies.clear();
+        pendingUnits.clear();
+        dirtyAtoms.clear();
+        trie.clear();
+        Atom largestAtom = 0;
+        for (const Clause& clause : f) {
+            if (subsumption) trie.insert(clause.begin(), clause.end());
+            liveClauses.insert(&clause);
+            if (!clause.empty()) largestAtom = std::max({ largestAtom, -*clause.begin(), *clause.rbegin() });
+            for (const Literal& literal : clause) {
+                const size_t index = literalIndex(literal);
+                if (index >= occurrences.size()) {
+                    occurrences.resize(2 * index + 2, 0);
+                    occurrenceLists.resize(2 * index + 2);
+                    dirty.resize(index + 1, false);
+                }
+                occurrences[index]++;
+                occurrenceLists[index].push_back(&clause);
+                if (!dirty[std::abs(literal)]) {
+                    dirty[std::abs(literal)] = true;
+                    dirtyAtoms.push_back(std::abs(literal));
+                }
+            }
+            if (clause.size() == 1) pendingUnits.push_back(*clause.begin());
+        }
+
+        narrow = largestAtom <= narrowAtoms;
+        eliminationEffort = 0;
+        tautologyPass = Pass{ tautologyPass.share };
+        unitPass = Pass{ unitPass.share };
+        purePass = Pass{ purePass.share };
+        eliminationOrder.clear();
+        orderPosition = 0;
+        eliminatedThisRound = true;
+        scheduling = true;
+    }
+
+    /**
+    * @brief Eliminates the atoms of the formula in rounds, running the simplification passes in between.
+    *
+    * Atoms whose elimination would add more than eliminationBound clauses are skipped while other atoms
+    *  can still be eliminated, and the bound is lifted as soon as every remaining atom would exceed it.
+    *  Atoms occurring with one sign only are pure and their clauses are removed, so every round makes progress
+    *  even when the pure literal pass does not run.
+    *
+    * The position in the round is kept in the solver, so the elimination can stop after the given quantum
+    *  of effort and be resumed by the next call, which lets one thread interleave many solves.
+    *
+    * @param f The normal form of the formula, prepared by startSolving().
+    * @param quantum The effort after which the elimination is suspended, UINT64_MAX to run it to the end.
+    * @return Progress Running if suspended, otherwise the answer.
+    */
+    Progress eliminate(NormalForm& f, uint64_t quantum) {
+        const uint64_t limit = quantum > UINT64_MAX - eliminationEffort ? UINT64_MAX : eliminationEffort + quantum;
+        auto finish = [this](bool answer) {
+            scheduling = false;
+            return answer ? Satisfiable : Unsatisfiable;
+        };
+        bool conflict = false;
+
+        while (eliminationEffort < limit) {
+            if (orderPosition == eliminationOrder.size()) {
+                // Every remaining atom exceeded the bound, so lift it
+                if (!eliminatedThisRound) eliminationBound = SIZE_MAX;
+
+                // Remove all possible variables
+                // Choose variables to remove using the maximum occurrence heuristic, or in random order
+                eliminationOrder.clear();
+                if (randomOrder) eliminationOrder = atomsRandomOrder();
+                else {
+                    std::map<Atom, unsigned> occurrence = maximumOccurrence(f);
+                    for (auto it = occurrence.rbegin(); it != occurrence.rend(); ++it) eliminationOrder.push_back(it->first);
+                }
+                orderPosition = 0;
+                eliminatedThisRound = false;
+                if (eliminationOrder.empty()) return finish(f.empty());  // no atoms left, so either no clauses or only the empty one
+            }
+            const Atom atom = eliminationOrder[orderPosition++];
+
+            // 1.-3. Remove tautology, unit and pure clauses, as scheduled
+            if (!runPasses(f)) return finish(false);  // UNSAT - empty clause
+
+            // 4. Check if formula is SAT or UNSAT
+            if (f.empty()) return finish(true);  // SAT - formula is empty
+            if (f.begin()->empty()) return finish(false);  // UNSAT - empty clause
+
+            // Variable to be potentially eliminated
+            const Atom literal = atom;
+
+            // Get the clauses containing the literal and the clauses containing the negation of the literal
+            auto clausesWith = allClausesWithGivenLiteral(f, literal);
+            auto clausesWithout = allClausesWithGivenLiteral(f, -literal);
+            eliminationEffort += 2 * f.size();
+
+            // If only one of the sets of clauses is empty, the literal is pure
+            if (clausesWith.empty() && clausesWithout.empty()) continue;
+            if (clausesWith.empty() || clausesWithout.empty()) {
+                for (const Clause& clause : clausesWith) eraseClause(f, clause);
+                for (const Clause& clause : clausesWithout) eraseClause(f, clause);
+                eliminatedThisRound = true;
+                continue;
+            }
+
+            // Leave atoms which would grow the formula too much for later
+            const size_t antecedents = clausesWith.size() + clausesWithout.size();
+            if (eliminationBound != SIZE_MAX && clausesWith.size() * clausesWithout.size() > antecedents + eliminationBound) continue;
+            eliminatedThisRound = true;
+
+            // Collect the resolved clauses and add them to the formula at once, narrow if their offsets fit
+            size_t literalBound = 0;
+            for (const Clause& clause : clausesWith) literalBound += clause.size() * clausesWithout.size();
+            for (const Clause& clause : clausesWithout) literalBound += clause.size() * clausesWith.size();
+            std::vector<Literal> units;
+            if (narrow && 3 * literalBound <= UINT32_MAX) {
+                if (!collectResolvents(narrowResolvents, clausesWith, clausesWithout, literal)) return finish(false);  // UNSAT - empty clause
+                units = mergeResolvents(f, narrowResolvents);
+            } else {
+                if (!collectResolvents(resolvents, clausesWith, clausesWithout, literal)) return finish(false);  // UNSAT - empty clause
+                units = mergeResolvents(f, resolvents);
+            }
+            eliminationEffort += clausesWith.size() * clausesWithout.size();
+
+            std::vector<Literal> newlyFalse;
+            for (const Literal& unit : units)
+                if (!falseLiterals.count(-unit)) {
+                    addFalseLiteral(-unit);
+                    newlyFalse.push_back(-unit);
+                }
+            eliminationEffort += removeFalseLiterals(f, std::move(newlyFalse), conflict);
+            if (conflict) return finish(false);   // UNSAT - empty clause
+
+            // Remove the clauses used for resolution from the formula
+            for (const Clause& clause : clausesWith) eraseClause(f, clause);
+            for (const Clause& clause : clausesWithout) eraseClause(f, clause);
+
+            // Update the list of literals
+            literals.erase(literal);
+            literals.erase(-literal);
+            falseLiterals.erase(literal);
+            falseLiterals.erase(-literal);
+        }
+
+        return Running;
+    }
+};
+
+/**
+* @struct FormulaSnapshot
+* Represents a persistent, copy-on-write view of a normal form, used when the search has to branch.
+*
+* The clauses of the original formula live in a shared immutable segment. Every snapshot only records
+*  the clauses it added or removed on top of it, and creating a branch freezes that delta into a layer
+*  shared by the parent and the child, so branching costs O(changes) instead of O(formula).
+*  Changes are kept on an undo trail and can be rolled back, also past the branches created since.
+*/
+struct FormulaSnapshot {
+    /**
+    * @struct Layer
+    * Frozen delta shared between snapshots, linked to the delta it was made on top of.
+    */
+    struct Layer {
+        std::shared_ptr<const Layer> parent;
+        NormalForm added;
+        NormalForm removed;
+        unsigned depth;
+    };
+
+    // Maximum number of frozen layers before they get merged into one
+    static constexpr unsigned maxLayerDepth = 16;
+
+    std::shared_ptr<const NormalForm> base;
+    std::shared_ptr<const Layer> frozen;
+    NormalForm added;
+    NormalForm removed;
+    std::vector<std::pair<bool, Clause>> trail;
+    size_t clauseCount;
+
+    /**
+    * @brief Creates a snapshot that shares the given formula as its immutable segment.
+    *
+    * @param f The normal form of the formula, which is copied once.
+    */
+    explicit FormulaSnapshot(const NormalForm& f)
+        : base(std::make_shared<const NormalForm>(f)), clauseCount(f.size()) {}
+
+    /**
+    * @brief Checks if the snapshot contains the given clause.
+    *
+    * The own delta is checked first, then the frozen layers from the newest to the oldest and finally the shared segment.
+    *
+    * @param clause The clause to be checked.
+    * @return bool True if the clause is present in the snapshot, false otherwise.
+    */
+    bool contains(const Clause& clause) const {
+        if (added.count(clause)) return true;
+        if (removed.count(clause)) return false;
+        for (const Layer* layer = frozen.get(); layer != nullptr; layer = layer->parent.get()) {
+            if (layer->added.count(clause)) return true;
+            if (layer->removed.count(clause)) return false;
+        }
+
+        return base->count(clause) != 0;
+    }
+
+    /**
+    * @brief Adds the clause to the snapshot and records the change on the undo trail.
+    *
+    * @param clause The clause to be added.
+    * @return bool True if the clause was not present before, false otherwise.
+    */
+    bool insert(const Clause& clause) {
+        if (contains(clause)) return false;
+        apply(true, clause);
+        trail.emplace_back(true, clause);
+        return true;
+    }
+
+    /**
+    * @brief Removes the clause from the snapshot and records the change on the undo trail.
+    *
+    * @param clause The clause to be removed.
+    * @return bool True if the clause was present before, false otherwise.
+    */
+    bool erase(const Clause& clause) {
+        if (!contains(clause)) return false;
+        apply(false, clause);
+        trail.emplace_back(false, clause);
+        return true;
+    }
+
+    /**
+    * @brief Returns the current position of the undo trail.
+    *
+    * @return size_t The mark which can later be passed to undo().
+    */
+    size_t mark() const {
+        return trail.size();
+    }
+
+    /**
+    * @brief Rolls back all changes recorded after the given mark.
+    *
+    * @param mark The position of the undo trail returned by mark().
+    */
+    void undo(size_t mark) {
+        while (trail.size() > mark) {
+            apply(!trail.back().first, trail.back().second);
+            trail.pop_back();
+        }
+    }
+
+    /**
+    * @brief Creates a new branch of the snapshot.
+    *
+    * The own delta is frozen into a layer shared by both snapshots, so the cost does not depend on the size of the formula.
+    *  This snapshot keeps its undo trail: undoing a frozen change records its inverse in the own delta, on top of
+    *  the layer. The child starts with an empty trail, so its first mark is the branch point.
+    *
+    * @return FormulaSnapshot The child snapshot, initially equal to this one.
+    */
+    FormulaSnapshot branch() {
+        if (!added.empty() || !removed.empty()) {
+            auto layer = std::make_shared<Layer>();
+            layer->parent = frozen;
+            layer->added = std::move(added);
+            layer->removed = std::move(removed);
+            layer->depth = frozen ? frozen->depth + 1 : 1;
+            frozen = layer->depth > maxLayerDepth ? mergeLayers(layer) : layer;
+            added.clear();
+            removed.clear();
+        }
+
+        std::vector<std::pair<bool, Clause>> own = std::move(trail);
+        trail.clear();
+        FormulaSnapshot child(*this);
+        trail = std::move(own);
+        return child;
+    }
+
+    /**
+    * @brief Builds the normal form represented by the snapshot.
+    *
+    * @return NormalForm The full copy of the formula, which costs O(formula).
+    */
+    NormalForm materialize() const {
+        std::vector<const Layer*> layers;
+        for (const Layer* layer = frozen.get(); layer != nullptr; layer = layer->parent.get())
+            layers.push_back(layer);
+
+        NormalForm f = *base;
+        for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
+            for (const Clause& clause : (*it)->removed) f.erase(clause);
+            for (const Clause& clause : (*it)->added) f.insert(clause);
+        }
+        for (const Clause& clause : removed) f.erase(clause);
+        for (const Clause& clause : added) f.insert(clause);
+
+        return f;
+    }
+
+    /**
+    * @brief Returns the number of clauses in the snapshot.
+    *
+    * @return size_t The number of clauses.
+    */
+    size_t size() const {
+        return clauseCount;
+    }
+
+private:
+    /**
+    * @brief Adds or removes the clause in the own delta, without touching the undo trail.
+    *
+    * The clause is assumed to be absent when it is added and present when it is removed.
+    *
+    * @param insert True if the clause should be added, false if it should be removed.
+    * @param clause The clause to be changed.
+    */
+    void apply(bool insert, const Clause& clause) {
+        NormalForm& same = insert ? added : removed;
+        NormalForm& opposite = insert ? removed : added;
+        if (opposite.erase(clause) == 0) same.insert(clause);
+
+        if (insert) clauseCount++;
+        else clauseCount--;
+    }
+
+    /**
+    * @brief Merges the chain of frozen layers into a single layer.
+    *
+    * The cost is proportional to the number of changes stored in the chain.
+    *
+    * @param newest The newest layer of the chain.
+    * @return std::shared_ptr<const Layer> The layer equivalent to the whole chain.
+    */
+    static std::shared_ptr<const Layer> mergeLayers(const std::shared_ptr<const Layer>& newest) {
+        std::vector<const Layer*> layers;
+        for (const Layer* layer = newest.get(); layer != nullptr; layer = layer->parent.get())
+            layers.push_back(layer);
+
+        auto merged = std::make_shared<Layer>();
+        merged->depth = 1;
+        for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
+            for (const Clause& clause : (*it)->removed)
+                if (merged->added.erase(clause) == 0) merged->removed.insert(clause);
+            for (const Clause& clause : (*it)->added)
+                if (merged->removed.erase(clause) == 0) merged->added.insert(clause);
+        }
+
+        return merged;
+    }
+};
+
+/**
+* @struct SymmetryBreaker
+* Detects symmetries of the formula and adds lex-leader clauses which break them.
+*
+* The formula is represented as a colored graph with a node for every literal and every clause, and an edge between
+*  a clause and each of its literals, as well as between a literal and its negation. Colors are refined until the
+*  partition is equitable. Generators are searched for by individualizing two atoms of the same cell and refining both
+*  partitions in parallel until they become discrete; the resulting permutation is kept only if it maps the formula onto itself.
+*  The search is bounded by a time budget, so it may miss symmetries, but every generator it reports is a real one.
+*/
+struct SymmetryBreaker {
+    using Permutation = std::vector<Atom>;
+
+    const NormalForm& formula;
+    std::vector<Atom> atoms;
+    std::vector<std::vector<int>> neighbours;
+    std::chrono::steady_clock::time_point deadline;
+    bool timedOut = false;
+
+    /**
+    * @brief Builds the colored graph of the formula.
+    *
+    * @param f The normal form of the formula.
+    * @param budget The time available for the detection.
+    */
+    SymmetryBreaker(const NormalForm& f, std::chrono::milliseconds budget)
+        : formula(f), deadline(std::chrono::steady_clock::now() + budget) {
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause) atoms.push_back(std::abs(literal));
+        std::sort(atoms.begin(), atoms.end());
+        atoms.erase(std::unique(atoms.begin(), atoms.end()), atoms.end());
+
+        neighbours.resize(2 * atoms.size() + f.size());
+        for (size_t i = 0; i < atoms.size(); i++) {
+            neighbours[2 * i].push_back(2 * i + 1);
+            neighbours[2 * i + 1].push_back(2 * i);
+        }
+
+        int node = 2 * atoms.size();
+        for (const Clause& clause : f) {
+            for (const Literal& literal : clause) {
+                neighbours[node].push_back(literalNode(literal));
+                neighbours[literalNode(literal)].push_back(node);
+            }
+            node++;
+        }
+    }
+
+    /**
+    * @brief Returns the graph node of the given literal.
+    *
+    * @param literal The literal.
+    * @return int The index of the node.
+    */
+    int literalNode(const Literal& literal) const {
+        const int index = std::lower_bound(atoms.begin(), atoms.end(), std::abs(literal)) - atoms.begin();
+        return 2 * index + (literal < 0);
+    }
+
+    /**
+    * @brief Refines the coloring until every two nodes of the same color have the same number of neighbours of each color.
+    *
+    * New colors are numbered by sorting the signatures of the nodes, so two colorings of isomorphic graphs
+    *  are refined into colorings which can be compared color by color.
+    *
+    * @param colors The coloring of the nodes, which will be modified.
+    * @return bool False if the time budget ran out, true otherwise.
+    */
+    bool refine(std::vector<int>& colors) {
+        size_t classes = std::set<int>(colors.begin(), colors.end()).size();
+        std::vector<std::vector<int>> signatures(colors.size());
+        std::vector<int> order(colors.size());
+        while (true) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                timedOut = true;
+                return false;
+            }
+
+            for (size_t node = 0; node < colors.size(); node++) {
+                signatures[node].assign(1, colors[node]);
+                for (int neighbour : neighbours[node]) signatures[node].push_back(colors[neighbour]);
+                std::sort(signatures[node].begin() + 1, signatures[node].end());
+            }
+
+            for (size_t node = 0; node < order.size(); node++) order[node] = node;
+            std::sort(order.begin(), order.end(), [&signatures](int a, int b) { return signatures[a] < signatures[b]; });
+
+            int color = 0;
+            for (size_t i = 0; i < order.size(); i++) {
+                if (i > 0 && signatures[order[i]] != signatures[order[i - 1]]) color++;
+                colors[order[i]] = color;
+            }
+
+            if (static_cast<size_t>(color + 1) == classes) return true;
+            classes = color + 1;
+        }
+    }
+
+    /**
+    * @brief Gives the node a color of its own and refines the coloring.
+    *
+    * @param colors The coloring of the nodes, which will be modified.
+    * @param node The node to be individualized.
+    * @return bool False if the time budget ran out, true otherwise.
+    */
+    bool individualize(std::vector<int>& colors, int node) {
+        colors[node] = *std::max_element(colors.begin(), colors.end()) + 1;
+        return refine(colors);
+    }
+
+    /**
+    * @brief Tries to find a symmetry which maps the first literal node onto the second one.
+    *
+    * Both colorings are individualized and refined in parallel, always choosing the smallest node of the first
+    *  non-singleton cell, until they become discrete. The search does not backtrack.
+    *
+    * @param base The equitable coloring of the graph.
+    * @param from The node of the first literal.
+    * @param to The node of the second literal.
+    * @param permutation Filled with the image of every atom, indexed by the position of the atom.
+    * @return bool True if a symmetry was found, false otherwise.
+    */
+    bool findSymmetry(const std::vector<int>& base, int from, int to, Permutation& permutation) {
+        std::vector<int> first = base, second = base;
+        if (!individualize(first, from) || !individualize(second, to)) return false;
+
+        while (true) {
+            std::vector<int> cellsFirst = first, cellsSecond = second;
+            std::sort(cellsFirst.begin(), cellsFirst.end());
+            std::sort(cellsSecond.begin(), cellsSecond.end());
+            if (cellsFirst != cellsSecond) return false;
+
+            auto repeated = std::adjacent_find(cellsFirst.begin(), cellsFirst.end());
+            if (repeated == cellsFirst.end()) break;
+
+            const int color = *repeated;
+            const int nodeFirst = std::find(first.begin(), first.end(), color) - first.begin();
+            const int nodeSecond = std::find(second.begin(), second.end(), color) - second.begin();
+            if (!individualize(first, nodeFirst) || !individualize(second, nodeSecond)) return false;
+        }
+
+        std::vector<int> nodeOfColor(first.size());
+        for (size_t node = 0; node < second.size(); node++) nodeOfColor[second[node]] = node;
+
+        permutation.assign(atoms.size(), 0);
+        for (size_t i = 0; i < atoms.size(); i++) {
+            const int positive = nodeOfColor[first[2 * i]], negative = nodeOfColor[first[2 * i + 1]];
+            if (positive % 2 != 0 || negative != positive + 1) return false;
+            permutation[i] = positive / 2;
+        }
+
+        return isSymmetry(permutation);
+    }
+
+    /**
+    * @brief Checks if the permutation of atoms maps every clause of the formula onto a clause of the formula.
+    *
+    * @param permutation The image of every atom, indexed by the position of the atom.
+    * @return bool True if the permutation is a symmetry of the formula, false otherwise.
+    */
+    bool isSymmetry(const Permutation& permutation) const {
+        for (const Clause& clause : formula) {
+            Clause image;
+            for (const Literal& literal : clause) {
+                const Atom atom = atoms[permutation[literalNode(literal) / 2]];
+                image.insert(literal > 0 ? atom : -atom);
+            }
+            if (formula.find(image) == formula.end()) return false;
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief Searches for generators of the symmetry group of the formula.
+    *
+    * For every cell of atoms, the first atom is mapped onto each of the others, skipping atoms which are already
+    *  known to be in its orbit.
+    *
+    * @return std::vector<Permutation> The generators found within the time budget.
+    */
+    std::vector<Permutation> findGenerators() {
+        std::vector<Permutation> generators;
+        std::vector<int> colors(neighbours.size(), 2);
+        for (size_t i = 0; i < atoms.size(); i++) {
+            colors[2 * i] = 0;
+            colors[2 * i + 1] = 1;
+        }
+        if (!refine(colors)) return generators;
+
+        // Orbits of atoms under the generators found so far
+        std::vector<int> orbit(atoms.size());
+        for (size_t i = 0; i < orbit.size(); i++) orbit[i] = i;
+        auto find = [&orbit](int i) {
+            while (orbit[i] != i) i = orbit[i] = orbit[orbit[i]];
+            return i;
+        };
+
+        std::map<int, std::vector<int>> cells;
+        for (size_t i = 0; i < atoms.size(); i++) cells[colors[2 * i]].push_back(i);
+
+        for (const auto& cell : cells) {
+            const std::vector<int>& members = cell.second;
+            for (size_t j = 1; j < members.size() && !timedOut; j++) {
+                if (find(members[0]) == find(members[j])) continue;
+
+                Permutation permutation;
+                if (!findSymmetry(colors, 2 * members[0], 2 * members[j], permutation)) continue;
+
+                for (size_t i = 0; i < permutation.size(); i++) orbit[find(i)] = find(permutation[i]);
+                generators.push_back(permutation);
+            }
+        }
+
+        return generators;
+    }
+
+    /**
+    * @brief Builds the lex-leader clauses for the given generator.
+    *
+    * The assignment restricted to the atoms moved by the generator, in increasing order, must be lexicographically
+    *  not greater than its image. Fresh atoms e(i) are implied by the equality of the first i positions.
+    *
+    * @param permutation The generator, mapping positions of atoms onto positions of atoms.
+    * @param maxLength The maximum number of positions to be constrained.
+    * @param nextAtom The first unused atom, which will be advanced for every fresh atom.
+    * @return std::vector<Clause> The symmetry-breaking clauses.
+    */
+    std::vector<Clause> lexLeader(const Permutation& permutation, size_t maxLength, Atom& nextAtom) const {
+        std::vector<Clause> clauses;
+        Literal equal = 0;  // e(i - 1), no literal for the empty prefix
+        size_t length = 0;
+        for (size_t i = 0; i < permutation.size() && length < maxLength; i++) {
+            if (permutation[i] == static_cast<Atom>(i)) continue;
+
+            const Literal x = atoms[i], y = atoms[permutation[i]];
+            auto withPrefix = [equal](Clause clause) {
+                if (equal != 0) clause.insert(-equal);
+                return clause;
+            };
+
+            clauses.push_back(withPrefix({ -x, y }));
+            if (++length == maxLength) break;
+
+            const Literal next = nextAtom++;
+            clauses.push_back(withPrefix({ x, y, next }));
+            clauses.push_back(withPrefix({ -x, -y, next }));
+            equal = next;
+        }
+
+        return clauses;
+    }
+};
+
+/**
+* @struct DirectionalResolution
+* Represents a knowledge base compiled from the formula by directional resolution.
+*
+* Atoms are processed in a fixed order, from the last to the first. Every clause is kept in the bucket of its last atom,
+*  and all resolvents on that atom are added to the buckets of earlier atoms. The buckets are kept after the elimination,
+*  so a model can be built without backtracking by assigning the atoms in order, each one satisfying its own bucket.
+*  The compiled knowledge base can be saved and loaded, so the elimination is paid for only once.
+*/
+struct DirectionalResolution {
+    using Literals = std::vector<Literal>;
+
+    enum Result { Consistent, Inconsistent, Unknown };
+
+    std::vector<Atom> order;
+    std::unordered_map<Atom, size_t> position;
+    std::vector<std::vector<Literals>> buckets;
+    bool consistent = true;
+
+    /**
+    * @brief Returns the position of the last atom of the clause in the order.
+    *
+    * @param clause The sorted literals of the clause.
+    * @return size_t The index of the bucket the clause belongs to.
+    */
+    size_t bucketOf(const Literals& clause) const {
+        size_t result = 0;
+        for (const Literal& literal : clause) result = std::max(result, position.at(std::abs(literal)));
+        return result;
+    }
+
+    /**
+    * @brief Sets the order of the atoms, which is the increasing order of the atoms in the formula.
+    *
+    * @param f The normal form of the formula.
+    */
+    void setOrder(const NormalForm& f) {
+        std::set<Atom> atoms;
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause) atoms.insert(std::abs(literal));
+
+        order.assign(atoms.begin(), atoms.end());
+        position.clear();
+        for (size_t i = 0; i < order.size(); i++) position[order[i]] = i;
+        buckets.assign(order.size(), {});
+    }
+
+    /**
+    * @brief Compiles the formula into the knowledge base.
+    *
+    * @param f The normal form of the formula.
+    * @return bool True if the formula is satisfiable, false otherwise.
+    */
+    bool compile(const NormalForm& f) {
+        setOrder(f);
+        consistent = true;
+
+        std::vector<std::set<Literals>> pending(order.size());
+        for (const Clause& clause : f) {
+            Literals literals(clause.begin(), clause.end());
+            if (literals.empty()) consistent = false;
+            else if (!ResolventBatch::isTautological(literals.data(), literals.size())) pending[bucketOf(literals)].insert(literals);
+        }
+
+        for (size_t i = order.size(); i-- > 0 && consistent; ) {
+            buckets[i].assign(pending[i].begin(), pending[i].end());
+            pending[i].clear();
+
+            const Atom atom = order[i];
+            std::vector<const Literals*> positive, negative;
+            for (const Literals& clause : buckets[i])
+                (std::binary_search(clause.begin(), clause.end(), atom) ? positive : negative).push_back(&clause);
+
+            for (const Literals* first : positive)
+                for (const Literals* second : negative) {
+                    Literals resolvent;
+                    for (const Literal& literal : *first) if (literal != atom) resolvent.push_back(literal);
+                    for (const Literal& literal : *second) if (literal != -atom) resolvent.push_back(literal);
+                    std::sort(resolvent.begin(), resolvent.end());
+                    resolvent.erase(std::unique(resolvent.begin(), resolvent.end()), resolvent.end());
+
+                    if (resolvent.empty()) {
+                        consistent = false;  // UNSAT - empty clause
+                        break;
+                    }
+                    if (!ResolventBatch::isTautological(resolvent.data(), resolvent.size()))
+                        pending[bucketOf(resolvent)].insert(resolvent);
+                }
+        }
+
+        return consistent;
+    }
+
+    /**
+    * @brief Checks if the knowledge base is consistent with the assumptions and builds a model if it is.
+    *
+    * The assumptions are first propagated over the clauses of all buckets, with a counter of the literals which
+    *  are not yet false in every clause. The remaining atoms are then assigned in order without backtracking,
+    *  each one to a value satisfying its own bucket. Both steps are linear in the size of the knowledge base.
+    *
+    * Without assumptions, or with assumptions only on the first atoms of the order, the second step always
+    *  succeeds. Otherwise a bucket of an assumed or propagated atom may be falsified by the values chosen for
+    *  earlier atoms; deciding such a query would need backtracking, so it is answered as unknown instead.
+    *
+    * @param assumptions The literals assumed to be true.
+    * @param model Filled with the value of every atom of the knowledge base and of the assumptions.
+    * @return Result Consistent with the model filled in, Inconsistent if the assumptions contradict the knowledge
+    *  base, or Unknown if the query cannot be decided in linear time.
+    */
+    Result query(const Literals& assumptions, Literals& model) const {
+        model.clear();
+        if (!consistent) return Inconsistent;
+
+        // 1 true, -1 false, 0 not assigned, for every position
+        std::vector<int> values(order.size(), 0);
+        std::map<Atom, int> outside;
+        std::vector<size_t> assigned;
+        for (const Literal& literal : assumptions) {
+            const int value = literal > 0 ? 1 : -1;
+            auto it = position.find(std::abs(literal));
+            int& slot = it != position.end() ? values[it->second] : outside[std::abs(literal)];
+            if (slot == -value) return Inconsistent;  // complementary assumptions
+            if (slot == 0 && it != position.end()) assigned.push_back(it->second);
+            slot = value;
+        }
+
+        auto valueOf = [&](const Literal& literal) {
+            const int value = values[position.at(std::abs(literal))];
+            return literal > 0 ? value : -value;
+        };
+
+        // Occurrences of every literal, indexed by twice the position of its atom, plus one for negative literals
+        std::vector<const Literals*> clauses;
+        std::vector<std::vector<size_t>> occurrences(2 * order.size());
+        for (const auto& bucket : buckets)
+            for (const Literals& clause : bucket) {
+                for (const Literal& literal : clause)
+                    occurrences[2 * position.at(std::abs(literal)) + (literal < 0)].push_back(clauses.size());
+                clauses.push_back(&clause);
+            }
+
+        // Unit propagation: a clause is looked at only when its last two literals which are not false become false
+        std::vector<size_t> open(clauses.size());
+        for (size_t c = 0; c < clauses.size(); c++) open[c] = clauses[c]->size();
+        for (size_t head = 0; head < assigned.size(); head++) {
+            const size_t i = assigned[head];
+            for (const size_t c : occurrences[2 * i + (values[i] > 0)]) {
+                if (--open[c] > 1) continue;
+
+                const Literal* unassigned = nullptr;
+                bool satisfied = false;
+                for (const Literal& literal : *clauses[c]) {
+                    const int value = valueOf(literal);
+                    if (value > 0) satisfied = true;
+                    else if (value == 0) unassigned = &literal;
+                }
+                if (satisfied) continue;
+                if (!unassigned) return Inconsistent;  // conflict
+
+                const size_t j = position.at(std::abs(*unassigned));
+                values[j] = *unassigned > 0 ? 1 : -1;
+                assigned.push_back(j);
+            }
+        }
+
+        auto satisfiesBucket = [&](size_t i) {
+            return std::all_of(buckets[i].begin(), buckets[i].end(), [&](const Literals& clause) {
+                return std::any_of(clause.begin(), clause.end(), [&](const Literal& literal) { return valueOf(literal) > 0; });
+            });
+        };
+
+        for (size_t i = 0; i < order.size(); i++) {
+            if (values[i] == 0) {
+                values[i] = 1;
+                if (!satisfiesBucket(i)) values[i] = -1;
+            }
+            if (!satisfiesBucket(i)) return Unknown;  // would need backtracking
+        }
+
+        for (size_t j = 0; j < order.size(); j++) model.push_back(values[j] > 0 ? order[j] : -order[j]);
+        for (const auto& atom : outside) model.push_back(atom.second > 0 ? atom.first : -atom.first);
+        return Consistent;
+    }
+
+    /**
+    * @brief Writes the knowledge base to the given output stream.
+    *
+    * The order of the atoms is written first, followed by the clauses of all buckets in the DIMACS format.
+    *
+    * @param fout The output stream.
+    */
+    void save(std::ostream& fout) const {
+        size_t clauses = consistent ? 0 : 1;
+        for (const auto& bucket : buckets) clauses += bucket.size();
+
+        fout << "p kb " << order.size() << " " << clauses << "\n";
+        for (const Atom& atom : order) fout << atom << " ";
+        fout << "0\n";
+        if (!consistent) fout << "0\n";
+        for (const auto& bucket : buckets)
+            for (const Literals& clause : bucket) {
+                for (const Literal& literal : clause) fout << literal << " ";
+                fout << "0\n";
+            }
+    }
+
+    /**
+    * @brief Reads a knowledge base written by save() from the given input stream.
+    *
+    * @param fin The input stream.
+    * @return bool True if the knowledge base was read successfully, false otherwise.
+    */
+    bool load(std::istream& fin) {
+        std::string p, kb;
+        size_t atoms = 0, clauses = 0;
+        if (!(fin >> p >> kb >> atoms >> clauses) || p != "p" || kb != "kb") return false;
+
+        order.clear();
+        position.clear();
+        Atom atom;
+        while (fin >> atom && atom != 0) {
+            position[atom] = order.size();
+            order.push_back(atom);
+        }
+        buckets.assign(order.size(), {});
+        consistent = true;
+
+        for (size_t i = 0; i < clauses; i++) {
+            Literals clause;
+            Literal literal;
+            while (fin >> literal && literal != 0) {
+                if (position.find(std::abs(literal)) == position.end()) return false;
+                clause.push_back(literal);
+            }
+            if (!fin) return false;
+
+            if (clause.empty()) consistent = false;
+            else buckets[bucketOf(clause)].push_back(clause);
+        }
+
+        return order.size() == atoms;
+    }
+};
+
+/**
+* @struct ModelCount
+* Represents an arbitrarily large non-negative integer, used for counting models.
+*/
+struct ModelCount {
+    // Base 2^32 digits, the least significant first
+    std::vector<uint32_t> digits;
+
+    ModelCount(uint64_t value = 0) {
+        while (value != 0) {
+            digits.push_back(static_cast<uint32_t>(value));
+            value >>= 32;
+        }
+    }
+
+    bool isZero() const {
+        return digits.empty();
+    }
+
+    ModelCount& operator+=(const ModelCount& other) {
+        uint64_t carry = 0;
+        if (digits.size() < other.digits.size()) digits.resize(other.digits.size(), 0);
+        for (size_t i = 0; i < digits.size(); i++) {
+            carry += static_cast<uint64_t>(digits[i]) + (i < other.digits.size() ? other.digits[i] : 0);
+            digits[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) digits.push_back(static_cast<uint32_t>(carry));
+        return *this;
+    }
+
+    ModelCount operator*(const ModelCount& other) const {
+        ModelCount result;
+        if (isZero() || other.isZero()) return result;
+
+        result.digits.assign(digits.size() + other.digits.size(), 0);
+        for (size_t i = 0; i < digits.size(); i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < other.digits.size() || carry != 0; j++) {
+                carry += result.digits[i + j] + static_cast<uint64_t>(digits[i]) * (j < other.digits.size() ? other.digits[j] : 0);
+                result.digits[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+        }
+        while (!result.digits.empty() && result.digits.back() == 0) result.digits.pop_back();
+        return result;
+    }
+
+    /**
+    * @brief Converts the number to its decimal representation.
+    *
+    * @return std::string The decimal digits of the number.
+    */
+    std::string toString() const {
+        if (isZero()) return "0";
+
+        std::vector<uint32_t> rest = digits;
+        std::string result;
+        while (!rest.empty()) {
+            uint64_t remainder = 0;
+            for (size_t i = rest.size(); i-- > 0; ) {
+                const uint64_t current = (remainder << 32) | rest[i];
+                rest[i] = static_cast<uint32_t>(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            while (!rest.empty() && rest.back() == 0) rest.pop_back();
+
+            std::string chunk = std::to_string(remainder);
+            if (!rest.empty()) chunk.insert(0, 9 - chunk.size(), '0');
+            result.insert(0, chunk);
+        }
+
+        return result;
+    }
+};
+
+/**
+* @struct DecisionDNNF
+* Represents a formula compiled into a smooth decision-DNNF circuit, stored as an array of nodes.
+*
+* The formula is compiled by an exhaustive search which propagates unit clauses, splits the formula into components
+*  without common atoms and caches the circuit of every component it has already compiled. Children of a node always
+*  come before it, so counting queries are answered by linear passes over the array. Atoms which disappear from a branch
+*  get a node (x or -x) of their own, which keeps the circuit smooth, so every model is counted exactly once.
+*/
+struct DecisionDNNF {
+    using Literals = std::vector<Literal>;
+
+    /**
+    * @struct Node
+    * A node of the circuit, whose children are stored in the shared array of edges.
+    */
+    struct Node {
+        enum Kind { True, False, Literal, And, Or };
+
+        Kind kind;
+        ::Literal literal;   // the literal of a Literal node, the decision atom of an Or node, 0 otherwise
+        size_t first;        // index of the first child in the array of edges
+        size_t count;        // number of children
+    };
+
+    std::vector<Node> nodes;
+    std::vector<size_t> edges;
+    Atom atomCount = 0;
+    size_t root = 0;
+
+    std::map<Literal, size_t> literalNodes;
+    std::map<Literals, size_t> componentCache;
+
+    /**
+    * @brief Adds a node with the given children to the circuit.
+    *
+    * @return size_t The index of the new node.
+    */
+    size_t addNode(Node::Kind kind, ::Literal literal, const std::vector<size_t>& children) {
+        nodes.push_back({ kind, literal, edges.size(), children.size() });
+        edges.insert(edges.end(), children.begin(), children.end());
+        return nodes.size() - 1;
+    }
+
+    /**
+    * @brief Returns the node of the given literal, creating it if needed.
+    *
+    * @param literal The literal.
+    * @return size_t The index of the node.
+    */
+    size_t literalNode(const Literal& literal) {
+        auto it = literalNodes.find(literal);
+        if (it != literalNodes.end()) return it->second;
+        return literalNodes[literal] = addNode(Node::Literal, literal, {});
+    }
+
+    /**
+    * @brief Builds the conjunction of the given nodes, simplifying constant children.
+    *
+    * @param children The nodes to be conjoined.
+    * @return size_t The index of the conjunction.
+    */
+    size_t conjoin(const std::vector<size_t>& children) {
+        std::vector<size_t> kept;
+        for (size_t child : children) {
+            if (nodes[child].kind == Node::False) return child;
+            if (nodes[child].kind != Node::True) kept.push_back(child);
+        }
+        if (kept.size() == 1) return kept.front();
+        return addNode(Node::And, 0, kept);
+    }
+
+    /**
+    * @brief Compiles the formula into the circuit.
+    *
+    * @param f The normal form of the formula.
+    * @param atoms The number of atoms of the formula; atoms not occurring in it are free.
+    */
+    void compile(const NormalForm& f, Atom atoms) {
+        nodes.clear();
+        edges.clear();
+        literalNodes.clear();
+        componentCache.clear();
+        atomCount = atoms;
+
+        std::vector<Literals> clauses;
+        for (const Clause& clause : f) {
+            Literals literals(clause.begin(), clause.end());
+            for (const Literal& literal : literals) atomCount = std::max(atomCount, std::abs(literal));
+            if (!ResolventBatch::isTautological(literals.data(), literals.size())) clauses.push_back(std::move(literals));
+        }
+
+        std::vector<Atom> all;
+        for (Atom atom = 1; atom <= atomCount; atom++) all.push_back(atom);
+        root = compileFormula(std::move(clauses), all);
+        componentCache.clear();
+
+        // Readers of the NNF format take the last node for the root
+        if (root != nodes.size() - 1) root = addNode(Node::And, 0, { root });
+    }
+
+    /**
+    * @brief Compiles a formula over the given atoms.
+    *
+    * Unit clauses are propagated, atoms which no longer occur become free, and the remaining clauses
+    *  are split into components which are compiled independently.
+    *
+    * @param clauses The clauses of the formula.
+    * @param atoms The sorted atoms the circuit has to mention.
+    * @return size_t The index of the node representing the formula.
+    */
+    size_t compileFormula(std::vector<Literals> clauses, const std::vector<Atom>& atoms) {
+        std::vector<size_t> children;
+        std::set<Atom> assigned;
+        while (true) {
+            auto unit = std::find_if(clauses.begin(), clauses.end(), [](const Literals& clause) { return clause.size() <= 1; });
+            if (unit == clauses.end()) break;
+            if (unit->empty()) return addNode(Node::False, 0, {});  // UNSAT - empty clause
+
+            const Literal literal = unit->front();
+            children.push_back(literalNode(literal));
+            assigned.insert(std::abs(literal));
+            clauses = condition(clauses, literal);
+        }
+
+        // Group the remaining clauses into components of connected atoms
+        std::map<Atom, Atom> parent;
+        std::function<Atom(Atom)> find = [&](Atom atom) {
+            Atom& p = parent.emplace(atom, atom).first->second;
+            if (p != atom) p = find(p);
+            return p;
+        };
+        for (const Literals& clause : clauses)
+            for (const Literal& literal : clause) parent[find(std::abs(literal))] = find(std::abs(clause.front()));
+
+        for (const Atom& atom : atoms)
+            if (assigned.count(atom) == 0 && parent.count(atom) == 0)
+                children.push_back(addNode(Node::Or, 0, { literalNode(atom), literalNode(-atom) }));  // free atom
+
+        std::map<Atom, std::vector<Literals>> components;
+        for (Literals& clause : clauses) components[find(std::abs(clause.front()))].push_back(std::move(clause));
+        for (auto& component : components) {
+            children.push_back(compileComponent(std::move(component.second)));
+            if (nodes[children.back()].kind == Node::False) return children.back();
+        }
+
+        return conjoin(children);
+    }
+
+    /**
+    * @brief Compiles a connected component without unit clauses, using the cache of compiled components.
+    *
+    * The atom occurring most often is chosen for the decision, and both of its values are compiled recursively.
+    *
+    * @param clauses The clauses of the component.
+    * @return size_t The index of the node representing the component.
+    */
+    size_t compileComponent(std::vector<Literals> clauses) {
+        std::sort(clauses.begin(), clauses.end());
+        Literals key;
+        for (const Literals& clause : clauses) {
+            key.insert(key.end(), clause.begin(), clause.end());
+            key.push_back(0);
+        }
+        auto cached = componentCache.find(key);
+        if (cached != componentCache.end()) return cached->second;
+
+        std::map<Atom, unsigned> occurrence;
+        for (const Literals& clause : clauses)
+            for (const Literal& literal : clause) occurrence[std::abs(literal)]++;
+
+        Atom decision = occurrence.begin()->first;
+        std::vector<Atom> rest;
+        for (const auto& entry : occurrence) {
+            if (entry.second > occurrence[decision]) decision = entry.first;
+            rest.push_back(entry.first);
+        }
+        rest.erase(std::find(rest.begin(), rest.end(), decision));
+
+        std::vector<size_t> branches;
+        for (const Literal& literal : { decision, -decision }) {
+            const size_t branch = conjoin({ literalNode(literal), compileFormula(condition(clauses, literal), rest) });
+            if (nodes[branch].kind != Node::False) branches.push_back(branch);
+        }
+
+        size_t result;
+        if (branches.empty()) result = addNode(Node::False, 0, {});
+        else if (branches.size() == 1) result = branches.front();
+        else result = addNode(Node::Or, decision, branches);
+
+        return componentCache[key] = result;
+    }
+
+    /**
+    * @brief Simplifies the clauses under the assumption that the literal is true.
+    *
+    * @param clauses The clauses to be simplified.
+    * @param literal The literal assumed to be true.
+    * @return std::vector<Literals> The clauses not satisfied by the literal, without its negation.
+    */
+    static std::vector<Literals> condition(const std::vector<Literals>& clauses, const Literal& literal) {
+        std::vector<Literals> result;
+        for (const Literals& clause : clauses) {
+            if (std::find(clause.begin(), clause.end(), literal) != clause.end()) continue;
+            result.push_back(clause);
+            result.back().erase(std::remove(result.back().begin(), result.back().end(), -literal), result.back().end());
+        }
+        return result;
+    }
+
+    /**
+    * @brief Computes the number of models of every node under the given assumptions, in a single pass.
+    *
+    * @param assumptions The literals assumed to be true.
+    * @return std::vector<ModelCount> The number of models of every node.
+    */
+    std::vector<ModelCount> counts(const Literals& assumptions) const {
+        std::set<Literal> falsified;
+        for (const Literal& literal : assumptions) falsified.insert(-literal);
+
+        std::vector<ModelCount> value(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const Node& node = nodes[i];
+            switch (node.kind) {
+                case Node::True: value[i] = 1; break;
+                case Node::False: value[i] = 0; break;
+                case Node::Literal: value[i] = falsified.count(node.literal) ? 0 : 1; break;
+                case Node::And:
+                    value[i] = 1;
+                    for (size_t j = 0; j < node.count; j++) value[i] = value[i] * value[edges[node.first + j]];
+                    break;
+                case Node::Or:
+                    for (size_t j = 0; j < node.count; j++) value[i] += value[edges[node.first + j]];
+                    break;
+            }
+        }
+
+        return value;
+    }
+
+    /**
+    * @brief Counts the models of the formula under the given assumptions.
+    *
+    * @param assumptions The literals assumed to be true.
+    * @return ModelCount The number of models.
+    */
+    ModelCount count(const Literals& assumptions) const {
+        if (nodes.empty()) return 0;
+        return counts(assumptions)[root];
+    }
+
+    /**
+    * @brief Counts, for every literal, the models of the formula under the assumptions in which the literal is true.
+    *
+    * The counts of all nodes are computed by a pass from the leaves, then the derivative of the root with respect
+    *  to every node by a pass from the root. Since the circuit is smooth and deterministic, the number of models
+    *  containing a literal is the derivative with respect to its node times its value.
+    *
+    * @param assumptions The literals assumed to be true.
+    * @return std::map<Literal, ModelCount> The number of models for every literal of every atom.
+    */
+    std::map<Literal, ModelCount> marginals(const Literals& assumptions) const {
+        std::map<Literal, ModelCount> result;
+        for (Atom atom = 1; atom <= atomCount; atom++) result[atom] = result[-atom] = 0;
+        if (nodes.empty()) return result;
+
+        const std::vector<ModelCount> value = counts(assumptions);
+        std::vector<ModelCount> derivative(nodes.size());
+        derivative[root] = 1;
+        for (size_t i = root + 1; i-- > 0; ) {
+            const Node& node = nodes[i];
+            if (derivative[i].isZero()) continue;
+
+            if (node.kind == Node::Or)
+                for (size_t j = 0; j < node.count; j++) derivative[edges[node.first + j]] += derivative[i];
+            else if (node.kind == Node::And) {
+                // Product of the values of all other children, from the prefix and suffix products
+                std::vector<ModelCount> suffix(node.count + 1, 1);
+                for (size_t j = node.count; j-- > 0; ) suffix[j] = suffix[j + 1] * value[edges[node.first + j]];
+                ModelCount prefix = derivative[i];
+                for (size_t j = 0; j < node.count; j++) {
+                    derivative[edges[node.first + j]] += prefix * suffix[j + 1];
+                    prefix = prefix * value[edges[node.first + j]];
+                }
+            }
+            else if (node.kind == Node::Literal) result[node.literal] += derivative[i] * value[i];
+        }
+
+        return result;
+    }
+
+    /**
+    * @brief Writes the circuit to the given output stream in the NNF format of the c2d compiler.
+    *
+    * The root is the last node, as the format requires, and is also named on a final line "c root R",
+    *  after the nodes, where readers of the c2d format do not look.
+    *
+    * @param fout The output stream.
+    */
+    void save(std::ostream& fout) const {
+        fout << "nnf " << nodes.size() << " " << edges.size() << " " << atomCount << "\n";
+        for (const Node& node : nodes) {
+            switch (node.kind) {
+                case Node::True: fout << "A 0"; break;
+                case Node::False: fout << "O 0 0"; break;
+                case Node::Literal: fout << "L " << node.literal; break;
+                case Node::And: fout << "A " << node.count; break;
+                case Node::Or: fout << "O " << node.literal << " " << node.count; break;
+            }
+            for (size_t j = 0; j < node.count; j++) fout << " " << edges[node.first + j];
+            fout << "\n";
+        }
+        fout << "c root " << root << "\n";
+    }
+
+    /**
+    * @brief Reads a circuit written by save() from the given input stream.
+    *
+    * Every child must come before its parent and the final line must name the last node as the root,
+    *  so a truncated or reordered file is rejected instead of giving wrong counts.
+    *
+    * @param fin The input stream.
+    * @return bool True if the circuit was read successfully, false otherwise.
+    */
+    bool load(std::istream& fin) {
+        std::string header;
+        size_t nodeCount = 0, edgeCount = 0;
+        if (!(fin >> header >> nodeCount >> edgeCount >> atomCount) || header != "nnf" || nodeCount == 0) return false;
+
+        nodes.clear();
+        edges.clear();
+        for (size_t i = 0; i < nodeCount; i++) {
+            std::string kind;
+            ::Literal literal = 0;
+            size_t count = 0;
+            if (!(fin >> kind)) return false;
+            if (kind == "L") fin >> literal;
+            else if (kind == "A") fin >> count;
+            else if (kind == "O") fin >> literal >> count;
+            else return false;
+
+            std::vector<size_t> children(count);
+            for (size_t& child : children)
+                if (!(fin >> child) || child >= i) return false;
+
+            Node::Kind type = kind == "L" ? Node::Literal : kind == "A" ? (count == 0 ? Node::True : Node::And)
+                                                                       : (count == 0 ? Node::False : Node::Or);
+            addNode(type, literal, children);
+        }
+
+        std::string comment, name;
+        size_t named = 0;
+        if (!(fin >> comment >> name >> named) || comment != "c" || name != "root" || named != nodes.size() - 1) return false;
+        root = named;
+        return edges.size() == edgeCount;
+    }
+};
+
+/**
+* @struct CDCL
+* Represents an incremental conflict-driven clause learning solver.
+*
+* Unlike DP::solve(), the solver keeps its state between calls: clauses can be added at any time and every call
+*  can assume a set of literals. A satisfiable call produces a model, and an unsatisfiable one produces the subset of
+*  the assumptions responsible for it, so engines which need many related checks can share one solver.
+*  It uses two watched literals per clause, first UIP learning, VSIDS ordering, phase saving and Luby restarts.
+*/
+struct CDCL {
+    enum Result { Satisfiable, Unsatisfiable, Unknown };
+
+    std::vector<std::vector<Literal>> clauses;
+    std::vector<std::vector<size_t>> watches;   // clauses watching each literal, indexed by index(literal)
+
+    std::vector<signed char> values;            // 1 true, -1 false, 0 unassigned, for every atom
+    std::vector<int> levels;
+    std::vector<long> reasons;                  // clause which implied the atom, -1 for decisions
+    std::vector<signed char> phases;
+    std::vector<Literal> assigned;
+    std::vector<size_t> levelStarts;
+    size_t propagated = 0;
+
+    std::vector<double> activity;
+    double activityIncrement = 1;
+    std::vector<Atom> heap;
+    std::vector<int> heapPosition;
+    std::vector<bool> seen;
+
+    Atom atomCount = 0;
+    bool inconsistent = false;
+    uint64_t conflicts = 0;
+    uint64_t conflictLimit = UINT64_MAX;
+
+    std::vector<Literal> model;
+    std::vector<Literal> core;
+
+    /**
+    * @brief Returns the index of the literal in the per-literal arrays.
+    */
+    static size_t index(const Literal& literal) {
+        return 2 * static_cast<size_t>(std::abs(literal)) + (literal < 0);
+    }
+
+    /**
+    * @brief Returns the value of the literal: 1 true, -1 false, 0 unassigned.
+    */
+    int value(const Literal& literal) const {
+        const int atomValue = values[std::abs(literal)];
+        return literal > 0 ? atomValue : -atomValue;
+    }
+
+    int decisionLevel() const {
+        return levelStarts.size();
+    }
+
+    /**
+    * @brief Makes sure the solver knows all atoms up to the given one.
+    *
+    * @param atom The largest atom to be known.
+    */
+    void reserveAtoms(Atom atom) {
+        if (atom <= atomCount) return;
+
+        values.resize(atom + 1, 0);
+        levels.resize(atom + 1, 0);
+        reasons.resize(atom + 1, -1);
+        phases.resize(atom + 1, -1);
+        activity.resize(atom + 1, 0);
+        heapPosition.resize(atom + 1, -1);
+        seen.resize(atom + 1, false);
+        watches.resize(2 * (atom + 1));
+        for (Atom a = atomCount + 1; a <= atom; a++) heapInsert(a);
+        atomCount = atom;
+    }
+
+    /**
+    * @brief Creates a fresh atom.
+    *
+    * @return Atom The new atom.
+    */
+    Atom newAtom() {
+        reserveAtoms(atomCount + 1);
+        return atomCount;
+    }
+
+    /**
+    * @brief Adds a clause to the solver, simplifying it by the assignments made at level zero.
+    *
+    * @param literals The literals of the clause.
+    * @return bool False if the solver became inconsistent, true otherwise.
+    */
+    bool addClause(std::vector<Literal> literals) {
+        if (inconsistent) return false;
+        backtrack(0);
+
+        for (const Literal& literal : literals) reserveAtoms(std::abs(literal));
+        std::sort(literals.begin(), literals.end());
+        literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+
+        size_t kept = 0;
+        for (const Literal& literal : literals) {
+            if (value(literal) > 0 || std::binary_search(literals.begin(), literals.end(), -literal)) return true;
+            if (value(literal) == 0) literals[kept++] = literal;
+        }
+        literals.resize(kept);
+
+        if (literals.empty()) return !(inconsistent = true);
+        if (literals.size() == 1) {
+            assign(literals[0], -1);
+            if (propagate() != -1) inconsistent = true;
+            return !inconsistent;
+        }
+
+        attach(std::move(literals));
+        return true;
+    }
+
+    /**
+    * @brief Solves the formula under the given assumptions.
+    *
+    * @param assumptions The literals assumed to be true for this call only.
+    * @return Result Satisfiable with the model filled in, Unsatisfiable with the failed assumptions in the core,
+    *  or Unknown if the conflict limit was reached.
+    */
+    Result solve(const std::vector<Literal>& assumptions = {}) {
+        model.clear();
+        core.clear();
+        if (inconsistent) return Unsatisfiable;
+        backtrack(0);
+        for (const Literal& literal : assumptions) reserveAtoms(std::abs(literal));
+
+        uint64_t restart = 1, nextRestart = conflicts + 100 * luby(restart);
+        while (true) {
+            const long conflict = propagate();
+            if (conflict != -1) {
+                conflicts++;
+                if (decisionLevel() == 0) {
+                    inconsistent = true;
+                    return Unsatisfiable;
+                }
+
+                int backtrackLevel;
+                std::vector<Literal> learnt = analyze(conflict, backtrackLevel);
+                backtrack(backtrackLevel);
+                if (learnt.size() == 1) assign(learnt[0], -1);
+                else {
+                    const Literal asserting = learnt[0];
+                    assign(asserting, attach(std::move(learnt)));
+                }
+                activityIncrement *= 1.05;
+                continue;
+            }
+
+            if (conflicts >= conflictLimit) {
+                backtrack(0);
+                return Unknown;
+            }
+            if (conflicts >= nextRestart) {
+                nextRestart = conflicts + 100 * luby(++restart);
+                backtrack(0);
+                continue;
+            }
+
+            // Assumptions are decided first, one per level
+            Literal decision = 0;
+            while (decisionLevel() < static_cast<int>(assumptions.size())) {
+                const Literal assumption = assumptions[decisionLevel()];
+                if (value(assumption) > 0) levelStarts.push_back(assigned.size());
+                else if (value(assumption) < 0) {
+                    analyzeFinal(assumption);
+                    backtrack(0);
+                    return Unsatisfiable;
+                }
+                else {
+                    decision = assumption;
+                    break;
+                }
+            }
+
+            if (decision == 0) {
+                while (!heap.empty() && values[heap.front()] != 0) heapPop();
+                if (heap.empty()) {
+                    for (Atom atom = 1; atom <= atomCount; atom++) model.push_back(values[atom] > 0 ? atom : -atom);
+                    backtrack(0);
+                    return Satisfiable;
+                }
+                const Atom atom = heapPop();
+                decision = phases[atom] > 0 ? atom : -atom;
+            }
+
+            levelStarts.push_back(assigned.size());
+            assign(decision, -1);
+        }
+    }
+
+private:
+    /**
+    * @brief Stores the clause and starts watching its first two literals.
+    *
+    * @return long The index of the clause.
+    */
+    long attach(std::vector<Literal> literals) {
+        watches[index(literals[0])].push_back(clauses.size());
+        watches[index(literals[1])].push_back(clauses.size());
+        clauses.push_back(std::move(literals));
+        return clauses.size() - 1;
+    }
+
+    void assign(const Literal& literal, long reason) {
+        const Atom atom = std::abs(literal);
+        values[atom] = literal > 0 ? 1 : -1;
+        levels[atom] = decisionLevel();
+        reasons[atom] = reason;
+        assigned.push_back(literal);
+    }
+
+    /**
+    * @brief Undoes all assignments made above the given decision level.
+    */
+    void backtrack(int level) {
+        if (decisionLevel() <= level) return;
+
+        for (size_t i = assigned.size(); i-- > levelStarts[level]; ) {
+            const Atom atom = std::abs(assigned[i]);
+            phases[atom] = values[atom];
+            values[atom] = 0;
+            reasons[atom] = -1;
+            if (heapPosition[atom] < 0) heapInsert(atom);
+        }
+        assigned.resize(levelStarts[level]);
+        levelStarts.resize(level);
+        propagated = std::min(propagated, assigned.size());
+    }
+
+    /**
+    * @brief Propagates all pending assignments through the watched literals.
+    *
+    * @return long The index of a falsified clause, or -1 if there is no conflict.
+    */
+    long propagate() {
+        while (propagated < assigned.size()) {
+            const Literal falsified = -assigned[propagated++];
+            std::vector<size_t>& watching = watches[index(falsified)];
+
+            size_t kept = 0;
+            for (size_t i = 0; i < watching.size(); i++) {
+                const size_t id = watching[i];
+                std::vector<Literal>& clause = clauses[id];
+                if (clause[0] == falsified) std::swap(clause[0], clause[1]);
+
+                if (value(clause[0]) > 0) {
+                    watching[kept++] = id;
+                    continue;
+                }
+
+                bool moved = false;
+                for (size_t j = 2; j < clause.size(); j++)
+                    if (value(clause[j]) >= 0) {
+                        std::swap(clause[1], clause[j]);
+                        watches[index(clause[1])].push_back(id);
+                        moved = true;
+                        break;
+                    }
+                if (moved) continue;
+
+                watching[kept++] = id;
+                if (value(clause[0]) < 0) {
+                    while (++i < watching.size()) watching[kept++] = watching[i];
+                    watching.resize(kept);
+                    propagated = assigned.size();
+                    return id;
+                }
+                assign(clause[0], id);
+            }
+            watching.resize(kept);
+        }
+
+        return -1;
+    }
+
+    /**
+    * @brief Derives the first UIP clause from the conflict and bumps the activity of the atoms involved.
+    *
+    * @param conflict The index of the falsified clause.
+    * @param backtrackLevel Set to the level at which the learnt clause becomes asserting.
+    * @return std::vector<Literal> The learnt clause, with the asserting literal first.
+    */
+    std::vector<Literal> analyze(long conflict, int& backtrackLevel) {
+        std::vector<Literal> learnt{ 0 };
+        int pending = 0;
+        Literal uip = 0;
+        size_t position = assigned.size();
+        long reason = conflict;
+
+        do {
+            for (const Literal& literal : clauses[reason]) {
+                const Atom atom = std::abs(literal);
+                if (literal == uip || seen[atom] || levels[atom] == 0) continue;
+
+                seen[atom] = true;
+                bump(atom);
+                if (levels[atom] == decisionLevel()) pending++;
+                else learnt.push_back(literal);
+            }
+
+            while (!seen[std::abs(assigned[--position])]) {}
+            uip = assigned[position];
+            reason = reasons[std::abs(uip)];
+            seen[std::abs(uip)] = false;
+            pending--;
+        } while (pending > 0);
+
+        learnt[0] = -uip;
+        backtrackLevel = 0;
+        size_t highest = 1;
+        for (size_t i = 1; i < learnt.size(); i++) {
+            seen[std::abs(learnt[i])] = false;
+            if (levels[std::abs(learnt[i])] > backtrackLevel) {
+                backtrackLevel = levels[std::abs(learnt[i])];
+                highest = i;
+            }
+        }
+        if (learnt.size() > 1) std::swap(learnt[1], learnt[highest]);
+
+        return learnt;
+    }
+
+    /**
+    * @brief Collects the assumptions which imply the negation of the given failed assumption.
+    *
+    * @param failed The assumption which is false under the previous assumptions.
+    */
+    void analyzeFinal(const Literal& failed) {
+        core.assign(1, failed);
+        if (decisionLevel() == 0) return;
+
+        seen[std::abs(failed)] = true;
+        for (size_t i = assigned.size(); i-- > levelStarts[0]; ) {
+            const Atom atom = std::abs(assigned[i]);
+            if (!seen[atom]) continue;
+
+            if (reasons[atom] == -1) core.push_back(assigned[i]);
+            else
+                for (const Literal& literal : clauses[reasons[atom]])
+                    if (levels[std::abs(literal)] > 0) seen[std::abs(literal)] = true;
+            seen[atom] = false;
+        }
+        seen[std::abs(failed)] = false;
+    }
+
+    /**
+    * @brief Returns the i-th element of the Luby sequence 1 1 2 1 1 2 4 ...
+    */
+    static uint64_t luby(uint64_t i) {
+        uint64_t size = 1, power = 1;
+        while (size < i) {
+            size = 2 * size + 1;
+            power *= 2;
+        }
+        while (size != i) {
+            size = (size - 1) / 2;
+            power /= 2;
+            if (i > size) i -= size;
+        }
+        return power;
+    }
+
+    void bump(Atom atom) {
+        activity[atom] += activityIncrement;
+        if (activity[atom] > 1e100) {
+            for (double& a : activity) a *= 1e-100;
+            activityIncrement *= 1e-100;
+        }
+        if (heapPosition[atom] >= 0) heapUp(heapPosition[atom]);
+    }
+
+    void heapInsert(Atom atom) {
+        heapPosition[atom] = heap.size();
+        heap.push_back(atom);
+        heapUp(heap.size() - 1);
+    }
+
+    Atom heapPop() {
+        const Atom top = heap.front();
+        heap.front() = heap.back();
+        heapPosition[heap.front()] = 0;
+        heap.pop_back();
+        heapPosition[top] = -1;
+        if (!heap.empty()) heapDown(0);
+        return top;
+    }
+
+    void heapUp(size_t i) {
+        const Atom atom = heap[i];
+        while (i > 0 && activity[heap[(i - 1) / 2]] < activity[atom]) {
+            heap[i] = heap[(i - 1) / 2];
+            heapPosition[heap[i]] = i;
+            i = (i - 1) / 2;
+        }
+        heap[i] = atom;
+        heapPosition[atom] = i;
+    }
+
+    void heapDown(size_t i) {
+        const Atom atom = heap[i];
+        while (2 * i + 1 < heap.size()) {
+            size_t child = 2 * i + 1;
+            if (child + 1 < heap.size() && activity[heap[child + 1]] > activity[heap[child]]) child++;
+            if (activity[heap[child]] <= activity[atom]) break;
+            heap[i] = heap[child];
+            heapPosition[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = atom;
+        heapPosition[atom] = i;
+    }
+};
+
+/**
+* @struct Backbone
+* Computes the backbone of the formula, the set of literals which are true in every model.
+*
+* All checks share one incremental solver. Candidates start as the literals of the first model and every later model
+*  removes the candidates it falsifies. Candidates are checked in chunks: a single call asks for a model falsifying
+*  at least one literal of the chunk, through a clause enabled by a fresh activation atom. If there is none, the whole
+*  chunk belongs to the backbone and the chunk grows; otherwise the model filters the candidates and the chunk shrinks.
+*/
+struct Backbone {
+    CDCL solver;
+    size_t calls = 0;
+
+    /**
+    * @brief Computes the backbone of the formula.
+    *
+    * @param f The normal form of the formula.
+    * @param backbone Filled with the backbone literals, in increasing order of their atoms.
+    * @return bool True if the formula is satisfiable, false otherwise.
+    */
+    bool compute(const NormalForm& f, std::vector<Literal>& backbone) {
+        backbone.clear();
+        std::set<Atom> atoms;
+        for (const Clause& clause : f) {
+            solver.addClause(std::vector<Literal>(clause.begin(), clause.end()));
+            for (const Literal& literal : clause) atoms.insert(std::abs(literal));
+        }
+
+        calls = 1;
+        if (solver.solve() != CDCL::Satisfiable) return false;
+
+        std::vector<Literal> candidates;
+        for (const Atom& atom : atoms) candidates.push_back(solver.model[atom - 1]);
+
+        size_t chunk = 1;
+        while (!candidates.empty()) {
+            const size_t size = std::min(chunk, candidates.size());
+            std::vector<Literal> checked(candidates.end() - size, candidates.end());
+
+            CDCL::Result result;
+            Atom activation = 0;
+            calls++;
+            if (size == 1) result = solver.solve({ -checked[0] });
+            else {
+                activation = solver.newAtom();
+                std::vector<Literal> clause{ -activation };
+                for (const Literal& literal : checked) clause.push_back(-literal);
+                solver.addClause(clause);
+                result = solver.solve({ activation });
+            }
+
+            if (result == CDCL::Unsatisfiable) {
+                for (const Literal& literal : checked) {
+                    backbone.push_back(literal);
+                    solver.addClause({ literal });
+                }
+                candidates.resize(candidates.size() - size);
+                chunk *= 2;
+            }
+            else {
+                // Keep only the candidates which are still true
+                size_t kept = 0;
+                for (const Literal& literal : candidates)
+                    if (solver.model[std::abs(literal) - 1] == literal) candidates[kept++] = literal;
+                candidates.resize(kept);
+                chunk = std::max<size_t>(1, chunk / 2);
+            }
+
+            if (activation != 0) solver.addClause({ -activation });
+        }
+
+        std::sort(backbone.begin(), backbone.end(), [](Literal a, Literal b) { return std::abs(a) < std::abs(b); });
+        return true;
+    }
+};
+
+/**
+* @struct MaxSAT
+* Represents a core-guided solver for weighted MaxSAT, implementing OLL with stratification on top of CDCL.
+*
+* Every soft clause gets an assumption literal which implies it. When the assumptions are unsatisfiable, the
+*  smallest weight in the core is added to the lower bound and taken from the weights of the core, and a
+*  totalizer counting the failed assumptions of the core is added, with a new assumption that at most one of
+*  them fails. Once that assumption fails in turn, the next one allows two failures, and so on.
+*  Stratification starts with the heaviest assumptions only, so good models come early, and every model
+*  found gives an upper bound which is reported as soon as it improves.
+*/
+struct MaxSAT {
+    CDCL solver;
+    std::map<Literal, uint64_t> weights;                      // weight of every active assumption
+    std::map<Literal, std::pair<size_t, size_t>> countBounds; // totalizer and output bounded by an assumption
+    std::vector<std::vector<Literal>> totalizers;             // output k is true if more than k inputs are true
+    uint64_t lowerBound = 0;
+    uint64_t upperBound = UINT64_MAX;
+    std::vector<Literal> bestModel;
+    size_t calls = 0;
+    std::function<void(uint64_t)> onImprovement;
+
+    /**
+    * @brief Builds a totalizer over the given range of inputs.
+    *
+    * Only the clauses forcing the outputs up are needed, as the outputs are only ever assumed to be false.
+    *
+    * @return std::vector<Literal> The outputs, where output k is implied when more than k inputs are true.
+    */
+    std::vector<Literal> count(const std::vector<Literal>& inputs, size_t begin, size_t end) {
+        if (end - begin == 1) return { inputs[begin] };
+
+        const size_t middle = (begin + end) / 2;
+        const std::vector<Literal> left = count(inputs, begin, middle), right = count(inputs, middle, end);
+        std::vector<Literal> outputs(left.size() + right.size());
+        for (Literal& output : outputs) output = solver.newAtom();
+
+        for (size_t i = 0; i <= left.size(); i++)
+            for (size_t j = 0; j <= right.size(); j++) {
+                if (i + j == 0) continue;
+                std::vector<Literal> clause{ outputs[i + j - 1] };
+                if (i > 0) clause.push_back(-left[i - 1]);
+                if (j > 0) clause.push_back(-right[j - 1]);
+                solver.addClause(clause);
+            }
+
+        return outputs;
+    }
+
+    /**
+    * @brief Computes the total weight of the soft clauses falsified by the model.
+    */
+    static uint64_t cost(const std::vector<std::pair<Clause, uint64_t>>& soft, const std::vector<Literal>& model) {
+        uint64_t total = 0;
+        for (const auto& [clause, weight] : soft)
+            if (std::none_of(clause.begin(), clause.end(), [&model](const Literal& literal) { return model[std::abs(literal) - 1] == literal; }))
+                total += weight;
+        return total;
+    }
+
+    /**
+    * @brief Shrinks the core by solving again under its own assumptions, while that keeps removing literals.
+    */
+    std::vector<Literal> trim(std::vector<Literal> core) {
+        for (int round = 0; round < 3 && core.size() > 1; round++) {
+            calls++;
+            if (solver.solve(core) != CDCL::Unsatisfiable || solver.core.size() >= core.size()) break;
+            core = solver.core;
+        }
+        return core;
+    }
+
+    /**
+    * @brief Finds a model of the hard clauses minimizing the total weight of the falsified soft clauses.
+    *
+    * @param hard The normal form of the hard clauses.
+    * @param soft The soft clauses with their weights.
+    * @param atoms The number of atoms of the formula.
+    * @return bool True if the hard clauses are satisfiable, with the optimum in upperBound and bestModel, false otherwise.
+    */
+    bool solve(const NormalForm& hard, const std::vector<std::pair<Clause, uint64_t>>& soft, Atom atoms) {
+        solver.reserveAtoms(atoms);
+        for (const Clause& clause : hard)
+            if (!solver.addClause(std::vector<Literal>(clause.begin(), clause.end()))) return false;  // UNSAT - hard clauses
+
+        for (const auto& [clause, weight] : soft) {
+            if (clause.empty()) lowerBound += weight;
+            else if (clause.size() == 1) weights[*clause.begin()] += weight;
+            else {
+                const Literal assumption = solver.newAtom();
+                std::vector<Literal> implication(clause.begin(), clause.end());
+                implication.push_back(-assumption);
+                solver.addClause(implication);
+                weights[assumption] += weight;
+            }
+        }
+
+        uint64_t threshold = 0;
+        for (const auto& [literal, weight] : weights) threshold = std::max(threshold, weight);
+
+        while (true) {
+            std::vector<Literal> assumptions;
+            for (const auto& [literal, weight] : weights)
+                if (weight >= threshold) assumptions.push_back(literal);
+
+            calls++;
+            if (solver.solve(assumptions) == CDCL::Satisfiable) {
+                const std::vector<Literal> model(solver.model.begin(), solver.model.begin() + atoms);
+                const uint64_t modelCost = cost(soft, model);
+                if (modelCost < upperBound) {
+                    upperBound = modelCost;
+                    bestModel = model;
+                    if (onImprovement) onImprovement(upperBound);
+                }
+                if (upperBound <= lowerBound) return true;
+
+                // Move to the next stratum, or stop when every assumption was already satisfied
+                uint64_t next = 0;
+                for (const auto& [literal, weight] : weights)
+                    if (weight < threshold) next = std::max(next, weight);
+                if (next == 0) return true;
+                threshold = next;
+                continue;
+            }
+
+            if (solver.core.empty()) return false;  // UNSAT - hard clauses
+            const std::vector<Literal> core = trim(solver.core);
+
+            uint64_t minimum = UINT64_MAX;
+            for (const Literal& literal : core) minimum = std::min(minimum, weights[literal]);
+            lowerBound += minimum;
+
+            for (const Literal& literal : core) {
+                if ((weights[literal] -= minimum) == 0) weights.erase(literal);
+
+                // A failed count bound is relaxed by one
+                auto bound = countBounds.find(literal);
+                if (bound == countBounds.end()) continue;
+                const auto [totalizer, output] = bound->second;
+                if (output + 1 < totalizers[totalizer].size()) {
+                    const Literal relaxed = -totalizers[totalizer][output + 1];
+                    weights[relaxed] += minimum;
+                    countBounds[relaxed] = { totalizer, output + 1 };
+                }
+            }
+
+            if (core.size() > 1) {
+                std::vector<Literal> failures;
+                for (const Literal& literal : core) failures.push_back(-literal);
+                totalizers.push_back(count(failures, 0, failures.size()));
+                const Literal atMostOne = -totalizers.back()[1];
+                weights[atMostOne] += minimum;
+                countBounds[atMostOne] = { totalizers.size() - 1, 1 };
+            }
+
+            if (lowerBound >= upperBound) return true;
+        }
+    }
+};
+
+/**
+* @struct XorSampler
+* Represents a near-uniform sampler of models, which partitions the models into cells with random XOR constraints.
+*
+* Each XOR contains every atom with probability one half and has a random parity, so m of them cut the models into
+*  2^m cells of nearly equal size. The number of XORs is adjusted until the models of a random cell can be
+*  enumerated, and one of them is chosen uniformly. As in UniGen, a cell is only used if its size lies between
+*  a lower and an upper threshold, so that small cells, whose models would be drawn too often, are rejected.
+*  Without XORs the cell holds all models and is used whatever its size. The XORs are brought to reduced row echelon form by Gaussian
+*  elimination, which drops dependent constraints and detects inconsistent ones before they reach the solver.
+*  Every cell is encoded behind its own activation literal, so one incremental solver serves all samples.
+*/
+struct XorSampler {
+    /**
+    * @struct Xor
+    * Represents an XOR constraint as a bitset over the atoms together with its parity.
+    */
+    struct Xor {
+        std::vector<uint64_t> atoms;   // bit a - 1 is set if atom a takes part
+        bool parity;
+    };
+
+    CDCL solver;
+    const NormalForm* formula = nullptr;
+    Atom atoms = 0;
+    std::mt19937_64 random;
+    size_t pivot = 32;       // the largest cell which is enumerated
+    size_t lowThreshold = 8; // the smallest cell which is used once XORs cut the models
+    size_t xorCount = 0;     // number of XORs which gave a good cell the last time
+    size_t calls = 0;
+
+    explicit XorSampler(uint64_t seed) : random(seed) {}
+
+    /**
+    * @brief Brings the XORs to reduced row echelon form.
+    *
+    * @param rows The XORs, which are replaced by the independent rows of the echelon form.
+    * @return bool False if the XORs are inconsistent, true otherwise.
+    */
+    bool eliminate(std::vector<Xor>& rows) const {
+        size_t rank = 0;
+        for (Atom atom = 1; atom <= atoms && rank < rows.size(); atom++) {
+            const size_t word = (atom - 1) / 64;
+            const uint64_t bit = uint64_t(1) << ((atom - 1) % 64);
+
+            size_t pivotRow = rank;
+            while (pivotRow < rows.size() && !(rows[pivotRow].atoms[word] & bit)) pivotRow++;
+            if (pivotRow == rows.size()) continue;
+            std::swap(rows[rank], rows[pivotRow]);
+
+            for (size_t i = 0; i < rows.size(); i++)
+                if (i != rank && (rows[i].atoms[word] & bit)) {
+                    for (size_t w = word; w < rows[i].atoms.size(); w++) rows[i].atoms[w] ^= rows[rank].atoms[w];
+                    rows[i].parity ^= rows[rank].parity;
+                }
+            rank++;
+        }
+
+        // The remaining rows are empty, and an empty row with odd parity cannot be satisfied
+        for (size_t i = rank; i < rows.size(); i++)
+            if (rows[i].parity) return false;
+        rows.resize(rank);
+        return true;
+    }
+
+    /**
+    * @brief Adds the XOR to the solver as a chain of Tseitin variables, enforced only under the activation literal.
+    */
+    void encode(const Xor& row, const Literal& activation) {
+        Literal sum = 0;
+        for (Atom atom = 1; atom <= atoms; atom++) {
+            if (!((row.atoms[(atom - 1) / 64] >> ((atom - 1) % 64)) & 1)) continue;
+            if (sum == 0) {
+                sum = atom;
+                continue;
+            }
+
+            // next = sum xor atom
+            const Literal next = solver.newAtom();
+            solver.addClause({ -next, sum, atom });
+            solver.addClause({ -next, -sum, -atom });
+            solver.addClause({ next, -sum, atom });
+            solver.addClause({ next, sum, -atom });
+            sum = next;
+        }
+        solver.addClause({ -activation, row.parity ? sum : -sum });
+    }
+
+    /**
+    * @brief Enumerates the models of a random cell cut by the given number of XORs.
+    *
+    * @param count The number of XORs.
+    * @param models Filled with the models of the cell, up to one more than the pivot.
+    */
+    void enumerateCell(size_t count, std::vector<std::vector<Literal>>& models) {
+        models.clear();
+
+        std::vector<Xor> rows;
+        do {
+            rows.assign(count, { std::vector<uint64_t>((atoms + 63) / 64), false });
+            for (Xor& row : rows) {
+                for (uint64_t& word : row.atoms) word = random();
+                if (atoms % 64) row.atoms.back() &= (uint64_t(1) << (atoms % 64)) - 1;
+                row.parity = random() & 1;
+            }
+        } while (!eliminate(rows));
+
+        // Retired cells leave their Tseitin atoms and clauses behind, so start over once they dominate
+        if (solver.atomCount > 2 * atoms + 1024) load();
+
+        const Literal activation = solver.newAtom();
+        for (const Xor& row : rows) encode(row, activation);
+
+        while (models.size() <= pivot) {
+            calls++;
+            if (solver.solve({ activation }) != CDCL::Satisfiable) break;
+            models.emplace_back(solver.model.begin(), solver.model.begin() + atoms);
+
+            std::vector<Literal> blocking{ -activation };
+            for (const Literal& literal : models.back()) blocking.push_back(-literal);
+            solver.addClause(blocking);
+        }
+
+        // Retire the cell, together with its blocking clauses
+        solver.addClause({ -activation });
+    }
+
+    /**
+    * @brief Replaces the solver by a fresh one holding only the clauses of the formula.
+    *
+    * @return bool False if the clauses are trivially inconsistent, true otherwise.
+    */
+    bool load() {
+        solver = CDCL();
+        solver.reserveAtoms(atoms);
+        for (const Clause& clause : *formula)
+            if (!solver.addClause(std::vector<Literal>(clause.begin(), clause.end()))) return false;
+        return true;
+    }
+
+    /**
+    * @brief Draws models of the formula.
+    *
+    * @param f The normal form of the formula.
+    * @param atomCount The number of atoms of the formula.
+    * @param count The number of models to draw.
+    * @param onSample Called with every model drawn.
+    * @return bool True if the formula is satisfiable, false otherwise.
+    */
+    bool sample(const NormalForm& f, Atom atomCount, size_t count, const std::function<void(const std::vector<Literal>&)>& onSample) {
+        formula = &f;
+        atoms = atomCount;
+        if (!load()) return false;  // UNSAT - empty clause
+        calls++;
+        if (solver.solve() != CDCL::Satisfiable) return false;  // UNSAT
+
+        std::vector<std::vector<Literal>> models;
+        for (size_t drawn = 0; drawn < count; ) {
+            enumerateCell(xorCount, models);
+            if (models.size() > pivot) xorCount = std::min<size_t>(xorCount + 1, atoms);
+            else if (models.empty() || (xorCount > 0 && models.size() < lowThreshold)) xorCount = xorCount > 0 ? xorCount - 1 : 0;
+            else {
+                onSample(models[std::uniform_int_distribution<size_t>(0, models.size() - 1)(random)]);
+                drawn++;
+            }
+        }
+
+        return true;
+    }
+};
+
+/**
+* @struct Subsumption
+* Represents a full subsumption and strengthening pass over the formula, whose checks run in parallel.
+*
+* A round copies the clauses into sorted vectors with occurrence lists, which stay read-only while threads check
+*  disjoint ranges of candidate clauses. A candidate is compared with the clauses containing its least frequent atom:
+*  it subsumes a clause containing all of its literals, and strengthens a clause containing all of them but one,
+*  which occurs negated, by removing that negation. The actions found are then sorted and applied by a single
+*  thread, at most one per clause and round, so the result does not depend on the number of threads.
+*/
+struct Subsumption {
+    /**
+    * @struct Action
+    * Represents the removal of a clause, or of one of its literals, found during the check phase.
+    */
+    struct Action {
+        uint32_t target;
+        uint32_t by;
+        Literal removed;        // 0 if the whole clause is removed
+
+        bool operator<(const Action& other) const {
+            return std::make_tuple(target, removed != 0, by) < std::make_tuple(other.target, other.removed != 0, other.by);
+        }
+    };
+
+    DP& solver;
+    NormalForm& f;
+    size_t threads;
+    size_t subsumed = 0;
+    size_t strengthened = 0;
+    size_t rounds = 0;
+
+    std::vector<std::vector<Literal>> clauses;
+    std::vector<uint64_t> signatures;                 // one bit per atom modulo 64
+    std::vector<std::vector<uint32_t>> occurrences;   // clauses containing every literal, indexed by DP::literalIndex
+
+    Subsumption(DP& dp, NormalForm& formula, size_t threadCount)
+        : solver(dp), f(formula), threads(std::max<size_t>(threadCount, 1)) {}
+
+    /**
+    * @brief Checks if the first clause subsumes the second one, or strengthens it on one negated literal.
+    *
+    * @param c The sorted literals of the candidate clause.
+    * @param d The sorted literals of the other clause.
+    * @param flipped Set to the literal of c occurring negated in d, or 0.
+    * @return bool True if c subsumes or strengthens d, false otherwise.
+    */
+    static bool check(const std::vector<Literal>& c, const std::vector<Literal>& d, Literal& flipped) {
+        flipped = 0;
+        for (const Literal& literal : c) {
+            if (std::binary_search(d.begin(), d.end(), literal)) continue;
+            if (flipped || !std::binary_search(d.begin(), d.end(), -literal)) return false;
+            flipped = literal;
+        }
+        return true;
+    }
+
+    /**
+    * @brief Finds the actions of the candidate clauses in the given range, without modifying anything shared.
+    */
+    void findActions(size_t begin, size_t end, std::vector<Action>& actions) const {
+        for (size_t i = begin; i < end; i++) {
+            const std::vector<Literal>& c = clauses[i];
+            if (c.empty()) continue;
+
+            Atom pivot = 0;
+            size_t fewest = SIZE_MAX;
+            for (const Literal& literal : c) {
+                const size_t count = occurrences[DP::literalIndex(literal)].size() + occurrences[DP::literalIndex(-literal)].size();
+                if (count < fewest) {
+                    fewest = count;
+                    pivot = std::abs(literal);
+                }
+            }
+
+            for (const Literal& side : { pivot, -pivot })
+                for (const uint32_t j : occurrences[DP::literalIndex(side)]) {
+                    if (j == i || clauses[j].size() < c.size() || (signatures[i] & ~signatures[j])) continue;
+                    Literal flipped;
+                    if (check(c, clauses[j], flipped)) actions.push_back({ j, static_cast<uint32_t>(i), -flipped });
+                }
+        }
+    }
+
+    /**
+    * @brief Runs rounds of subsumption and strengthening until neither applies.
+    *
+    * @return bool False if strengthening produced an empty clause, true otherwise.
+    */
+    bool run() {
+        while (true) {
+            rounds++;
+            clauses.clear();
+            signatures.clear();
+            occurrences.clear();
+            for (const Clause& clause : f) {
+                std::vector<Literal> literals(clause.begin(), clause.end());
+                if (ResolventBatch::isTautological(literals.data(), literals.size())) continue;  // left to the tautology pass
+
+                uint64_t signature = 0;
+                for (const Literal& literal : clause) {
+                    const size_t index = DP::literalIndex(literal);
+                    if (index >= occurrences.size()) occurrences.resize(2 * index + 2);
+                    occurrences[index].push_back(clauses.size());
+                    signature |= uint64_t(1) << (std::abs(literal) % 64);
+                }
+                clauses.push_back(std::move(literals));
+                signatures.push_back(signature);
+            }
+
+            // Check phase: every thread takes a contiguous range of candidates
+            const size_t workers = std::min(threads, std::max<size_t>(clauses.size(), 1));
+            std::vector<std::vector<Action>> found(workers);
+            std::vector<std::thread> pool;
+            for (size_t t = 1; t < workers; t++)
+                pool.emplace_back([this, &found, t, workers]() {
+                    findActions(clauses.size() * t / workers, clauses.size() * (t + 1) / workers, found[t]);
+                });
+            findActions(0, clauses.size() / workers, found[0]);
+            for (std::thread& thread : pool) thread.join();
+
+            std::vector<Action> actions;
+            for (const std::vector<Action>& part : found) actions.insert(actions.end(), part.begin(), part.end());
+            if (actions.empty()) return true;
+            std::sort(actions.begin(), actions.end());
+
+            // Apply phase: the first action of every clause, in a fixed order
+            for (size_t k = 0; k < actions.size(); k++) {
+                const Action& action = actions[k];
+                if (k > 0 && actions[k - 1].target == action.target) continue;
+
+                const std::vector<Literal>& target = clauses[action.target];
+                solver.eraseClause(f, Clause(target.begin(), target.end()));
+                if (action.removed == 0) {
+                    subsumed++;
+                    continue;
+                }
+
+                Clause strengthenedClause(target.begin(), target.end());
+                strengthenedClause.erase(action.removed);
+                if (strengthenedClause.empty()) return false;  // UNSAT - empty clause
+                solver.insertClause(f, strengthenedClause);
+                strengthened++;
+            }
+        }
+    }
+};
+
+/**
+* @struct Stalmarck
+* Represents a Stålmarck-style saturation engine working on top of the simplifications of DP.
+*
+* The dilemma rule branches on both values of an atom, propagates each of them with the unit propagation of DP,
+*  recorded on its trail so the branch can be undone, and keeps what both branches agree on: literals implied
+*  by both of them become units, and literals implied with opposite signs become equivalent to the atom.
+*  A branch which fails implies the other one. Saturating with nested dilemmas up to depth k gives k-saturation.
+*  Equivalences are then substituted away, collapsing each class of equivalent literals into a single one.
+*/
+struct Stalmarck {
+    DP& solver;
+    NormalForm& f;
+    bool satisfiable = false;   // some branch satisfied every clause
+    size_t dilemmas = 0;
+    int depth = 0;
+
+    Stalmarck(DP& dp, NormalForm& formula) : solver(dp), f(formula) {}
+
+    /**
+    * @brief Checks if the literal is currently true.
+    */
+    bool isTrue(const Literal& literal) const {
+        return solver.falseLiterals.count(-literal) != 0;
+    }
+
+    /**
+    * @brief Checks if every clause of the formula contains a true literal.
+    */
+    bool allSatisfied() const {
+        for (const Clause& clause : f)
+            if (std::none_of(clause.begin(), clause.end(), [this](const Literal& literal) { return isTrue(literal); }))
+                return false;
+        return true;
+    }
+
+    /**
+    * @brief Assumes the literal, propagates it, saturates the branch to the given level and undoes all the changes.
+    *
+    * @param literal The literal assumed to be true.
+    * @param level The depth of the dilemma rule, 1 meaning only propagation.
+    * @param implied Filled with the literals which became true in the branch.
+    * @return bool True if the branch leads to a conflict, false otherwise.
+    */
+    bool branch(const Literal& literal, int level, std::vector<Literal>& implied) {
+        implied.clear();
+        if (solver.falseLiterals.count(literal)) return true;
+
+        const size_t mark = solver.trailMark();
+        const bool wasRecording = solver.recording;
+        solver.recording = true;
+
+        bool conflict = false;
+        solver.insertClause(f, Clause{ literal });
+        solver.removeUnitClauses(f, conflict);
+        if (!conflict && level > 1) conflict = !saturate(level - 1);
+        if (!conflict && !satisfiable && allSatisfied()) satisfiable = true;
+
+        for (size_t i = mark; i < solver.trail.size(); i++)
+            if (solver.trail[i].kind == DP::TrailEntry::AddFalseLiteral) implied.push_back(-solver.trail[i].literal);
+
+        solver.undo(f, mark);
+        solver.recording = wasRecording;
+        return conflict;
+    }
+
+    /**
+    * @brief Applies the dilemma rule to every unassigned atom until nothing new is learnt.
+    *
+    * @param level The depth of the dilemma rule.
+    * @return bool False if the formula is unsatisfiable, true otherwise.
+    */
+    bool saturate(int level) {
+        bool changed = true;
+        while (changed && !satisfiable) {
+            changed = false;
+
+            std::set<Atom> atoms;
+            for (const Clause& clause : f)
+                for (const Literal& literal : clause)
+                    if (!isTrue(literal) && !isTrue(-literal)) atoms.insert(std::abs(literal));
+
+            for (const Atom& atom : atoms) {
+                if (isTrue(atom) || isTrue(-atom)) continue;
+                dilemmas++;
+
+                std::vector<Literal> positive, negative;
+                const bool positiveConflict = branch(atom, level, positive);
+                if (satisfiable) return true;
+                const bool negativeConflict = branch(-atom, level, negative);
+                if (satisfiable) return true;
+                if (positiveConflict && negativeConflict) return false;  // UNSAT - both branches fail
+
+                std::vector<Clause> learnt;
+                if (positiveConflict) learnt.push_back({ -atom });
+                else if (negativeConflict) learnt.push_back({ atom });
+                else {
+                    std::sort(negative.begin(), negative.end());
+                    for (const Literal& literal : positive) {
+                        if (std::abs(literal) == atom || isTrue(literal)) continue;
+                        if (std::binary_search(negative.begin(), negative.end(), literal)) learnt.push_back({ literal });
+                        else if (std::binary_search(negative.begin(), negative.end(), -literal)) {
+                            learnt.push_back({ -atom, literal });
+                            learnt.push_back({ atom, -literal });
+                        }
+                    }
+                }
+
+                for (const Clause& clause : learnt)
+                    if (solver.insertClause(f, clause)) changed = true;
+
+                bool conflict = false;
+                solver.removeUnitClauses(f, conflict);
+                if (conflict) return false;  // UNSAT - empty clause
+            }
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief Removes satisfied clauses and false literals, then substitutes equivalent literals.
+    *
+    * Equivalences are the strongly connected components of the implication graph of the binary clauses.
+    *  Every literal is replaced by the literal of the smallest atom of its component.
+    *
+    * @return bool False if the formula is unsatisfiable, true otherwise.
+    */
+    bool simplify() {
+        bool conflict = false;
+        solver.removeUnitClauses(f, conflict);
+        if (conflict) return false;  // UNSAT - conflict clauses
+
+        NormalForm cleaned;
+        for (const Clause& clause : f) {
+            if (std::any_of(clause.begin(), clause.end(), [this](const Literal& literal) { return isTrue(literal); })) continue;
+            Clause rest;
+            for (const Literal& literal : clause)
+                if (!isTrue(-literal)) rest.insert(literal);
+            if (rest.empty()) return false;  // UNSAT - empty clause
+            cleaned.insert(rest);
+        }
+
+        // Implication graph of the binary clauses, over literal nodes
+        std::vector<Atom> atoms;
+        for (const Clause& clause : cleaned)
+            for (const Literal& literal : clause) atoms.push_back(std::abs(literal));
+        std::sort(atoms.begin(), atoms.end());
+        atoms.erase(std::unique(atoms.begin(), atoms.end()), atoms.end());
+
+        auto node = [&atoms](const Literal& literal) {
+            return 2 * static_cast<int>(std::lower_bound(atoms.begin(), atoms.end(), std::abs(literal)) - atoms.begin()) + (literal < 0);
+        };
+        auto literalOf = [&atoms](int index) { return index % 2 == 0 ? atoms[index / 2] : -atoms[index / 2]; };
+
+        std::vector<std::vector<int>> implications(2 * atoms.size());
+        for (const Clause& clause : cleaned)
+            if (clause.size() == 2) {
+                const Literal a = *clause.begin(), b = *clause.rbegin();
+                implications[node(-a)].push_back(node(b));
+                implications[node(-b)].push_back(node(a));
+            }
+
+        std::vector<int> component = stronglyConnectedComponents(implications);
+        std::map<int, Literal> representative;
+        for (size_t i = 0; i < component.size(); i++) {
+            if (component[i] == component[i ^ 1]) return false;  // UNSAT - a literal is equivalent to its negation
+            auto it = representative.find(component[i]);
+            if (it == representative.end() || std::abs(literalOf(i)) < std::abs(it->second)) representative[component[i]] = literalOf(i);
+        }
+
+        f.clear();
+        for (const Clause& clause : cleaned) {
+            Clause substituted;
+            for (const Literal& literal : clause) substituted.insert(representative[component[node(literal)]]);
+            if (!solver.isTautologicClause(substituted)) f.insert(substituted);
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief Decides the formula by saturating it with increasing depth.
+    *
+    * Saturation deeper than the number of atoms tries every assignment, so the loop always terminates.
+    *
+    * @return bool True if the formula is satisfiable, false otherwise.
+    */
+    bool solve() {
+        for (depth = 1; ; depth++) {
+            if (!simplify()) return false;
+            if (f.empty()) return true;
+            if (!saturate(depth)) return false;
+            if (satisfiable) return true;
+        }
+    }
+
+    /**
+    * @brief Finds the strongly connected components of the graph with Tarjan's algorithm, without recursion.
+    *
+    * @param graph The adjacency lists of the graph.
+    * @return std::vector<int> The component of every node.
+    */
+    static std::vector<int> stronglyConnectedComponents(const std::vector<std::vector<int>>& graph) {
+        const int n = graph.size();
+        std::vector<int> index(n, -1), low(n, 0), component(n, -1), stack;
+        std::vector<bool> onStack(n, false);
+        std::vector<std::pair<int, size_t>> calls;
+        int counter = 0, components = 0;
+
+        for (int start = 0; start < n; start++) {
+            if (index[start] != -1) continue;
+            calls.emplace_back(start, 0);
+            while (!calls.empty()) {
+                int v = calls.back().first;
+                size_t& next = calls.back().second;
+                if (index[v] == -1) {
+                    index[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    onStack[v] = true;
+                }
+
+                if (next < graph[v].size()) {
+                    const int w = graph[v][next++];
+                    if (index[w] == -1) calls.emplace_back(w, 0);
+                    else if (onStack[w]) low[v] = std::min(low[v], index[w]);
+                    continue;
+                }
+
+                if (low[v] == index[v]) {
+                    int w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        onStack[w] = false;
+                        component[w] = components;
+                    } while (w != v);
+                    components++;
+                }
+                calls.pop_back();
+                if (!calls.empty()) low[calls.back().first] = std::min(low[calls.back().first], low[v]);
+            }
+        }
+
+        return component;
+    }
+};
+
+/**
+* @struct TreeDecomposition
+* Represents a solver which runs dynamic programming over a tree decomposition of the primal graph.
+*
+* The decomposition comes from an elimination ordering, chosen greedily by minimum fill-in while the time budget
+*  lasts and by minimum degree afterwards. Eliminating an atom creates a bag with the atom and its neighbours.
+*  The table of a bag marks the assignments of the bag which can be extended to all clauses below it, and is
+*  passed to the parent bag with the eliminated atom projected out. Tables are bitsets with one bit per
+*  assignment, so the running time is exponential only in the width of the decomposition.
+*/
+struct TreeDecomposition {
+    std::vector<Atom> atoms;                  // atom of every vertex
+    std::vector<int> order;                   // vertices in the order of elimination
+    std::vector<int> position;                // position of every vertex in the order
+    std::vector<std::vector<int>> bags;       // neighbours of every vertex when eliminated, followed by the vertex
+    int width = 0;
+    bool minFillTimedOut = false;
+
+    /**
+    * @brief Finds the vertex of the literal.
+    */
+    int vertex(const Literal& literal) const {
+        return std::lower_bound(atoms.begin(), atoms.end(), std::abs(literal)) - atoms.begin();
+    }
+
+    /**
+    * @brief Counts the edges which eliminating the vertex would add between its neighbours.
+    */
+    static size_t fillIn(const std::vector<std::set<int>>& graph, int v) {
+        size_t fill = 0;
+        for (auto a = graph[v].begin(); a != graph[v].end(); ++a)
+            for (auto b = std::next(a); b != graph[v].end(); ++b)
+                if (!graph[*a].count(*b)) fill++;
+        return fill;
+    }
+
+    /**
+    * @brief Computes an elimination ordering of the primal graph of the formula and the bags it creates.
+    *
+    * @param f The normal form of the formula.
+    * @param budget The time for choosing vertices by minimum fill-in, after which minimum degree is used.
+    * @param maxWidth The largest width worth solving.
+    * @return bool True if the width does not exceed the maximum width, false otherwise.
+    */
+    bool decompose(const NormalForm& f, std::chrono::milliseconds budget, int maxWidth) {
+        atoms.clear();
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause) atoms.push_back(std::abs(literal));
+        std::sort(atoms.begin(), atoms.end());
+        atoms.erase(std::unique(atoms.begin(), atoms.end()), atoms.end());
+
+        const int n = atoms.size();
+        std::vector<std::set<int>> graph(n);
+        for (const Clause& clause : f)
+            for (const Literal& a : clause)
+                for (const Literal& b : clause)
+                    if (std::abs(a) != std::abs(b)) graph[vertex(a)].insert(vertex(b));
+
+        // Vertices ordered by degree and by fill-in, the latter only updated around eliminated vertices
+        std::set<std::pair<size_t, int>> degrees, fills;
+        std::vector<size_t> fill(n);
+        minFillTimedOut = budget.count() <= 0;
+        for (int v = 0; v < n; v++) {
+            degrees.emplace(graph[v].size(), v);
+            if (minFillTimedOut) continue;
+            fill[v] = fillIn(graph, v);
+            fills.emplace(fill[v], v);
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        order.clear();
+        position.assign(n, 0);
+        bags.assign(n, {});
+        width = 0;
+
+        for (int step = 0; step < n; step++) {
+            if (!minFillTimedOut && std::chrono::steady_clock::now() > deadline) minFillTimedOut = true;
+
+            // Eliminate the vertex, turning its neighbours into a clique
+            const int v = minFillTimedOut ? degrees.begin()->second : fills.begin()->second;
+            bags[v].assign(graph[v].begin(), graph[v].end());
+            bags[v].push_back(v);
+            width = std::max(width, static_cast<int>(graph[v].size()));
+            if (width > maxWidth) return false;
+
+            degrees.erase({ graph[v].size(), v });
+            fills.erase({ fill[v], v });
+            for (const int a : graph[v]) {
+                degrees.erase({ graph[a].size(), a });
+                graph[a].erase(v);
+                for (const int b : graph[v])
+                    if (a != b) graph[a].insert(b);
+                degrees.emplace(graph[a].size(), a);
+            }
+
+            if (!minFillTimedOut) {
+                std::set<int> touched;
+                for (const int a : graph[v]) {
+                    touched.insert(a);
+                    touched.insert(graph[a].begin(), graph[a].end());
+                }
+                for (const int u : touched) {
+                    if (u == v) continue;
+                    fills.erase({ fill[u], u });
+                    fill[u] = fillIn(graph, u);
+                    fills.emplace(fill[u], u);
+                }
+            }
+            graph[v].clear();
+
+            position[v] = step;
+            order.push_back(v);
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief Decides the formula by passing the tables of the bags to their parents.
+    *
+    * Bit i of a table belongs to the assignment whose j-th atom of the bag is true iff bit j of i is set,
+    *  so the eliminated atom, which is the last one of its bag, selects the upper half of the table.
+    *
+    * @param f The normal form of the formula, already decomposed.
+    * @return bool True if the formula is satisfiable, false otherwise.
+    */
+    bool solve(const NormalForm& f) const {
+        const int n = atoms.size();
+
+        // Every clause belongs to the bag of its atom eliminated first, which contains all of its atoms
+        std::vector<std::vector<const Clause*>> clauses(n);
+        for (const Clause& clause : f) {
+            if (clause.empty()) return false;  // UNSAT - empty clause
+            int first = vertex(*clause.begin());
+            for (const Literal& literal : clause)
+                if (position[vertex(literal)] < position[first]) first = vertex(literal);
+            clauses[first].push_back(&clause);
+        }
+
+        // Tables sent to every bag by its children, together with their vertices
+        std::vector<std::vector<std::pair<std::vector<int>, std::vector<uint64_t>>>> inbox(n);
+
+        for (const int v : order) {
+            const std::vector<int>& bag = bags[v];
+            const size_t k = bag.size();
+            const uint64_t assignments = uint64_t(1) << k;
+            auto bit = [&bag](int u) { return static_cast<size_t>(std::find(bag.begin(), bag.end(), u) - bag.begin()); };
+
+            std::vector<uint64_t> table(std::max<uint64_t>(1, assignments / 64), ~uint64_t(0));
+            if (assignments < 64) table[0] = (uint64_t(1) << assignments) - 1;
+
+            // Remove the assignments falsifying a clause
+            for (const Clause* clause : clauses[v]) {
+                uint64_t fixed = 0, falsifying = 0;
+                for (const Literal& literal : *clause) {
+                    fixed |= uint64_t(1) << bit(vertex(literal));
+                    if (literal < 0) falsifying |= uint64_t(1) << bit(vertex(literal));
+                }
+                const uint64_t free = (assignments - 1) & ~fixed;
+                for (uint64_t rest = free; ; rest = (rest - 1) & free) {
+                    const uint64_t i = falsifying | rest;
+                    table[i / 64] &= ~(uint64_t(1) << (i % 64));
+                    if (rest == 0) break;
+                }
+            }
+
+            // Keep the assignments which agree with an extendable assignment of every child
+            for (const auto& message : inbox[v]) {
+                std::vector<size_t> bits;
+                for (const int u : message.first) bits.push_back(bit(u));
+                for (uint64_t i = 0; i < assignments; i++) {
+                    uint64_t j = 0;
+                    for (size_t b = 0; b < bits.size(); b++) j |= ((i >> bits[b]) & 1) << b;
+                    if (!((message.second[j / 64] >> (j % 64)) & 1)) table[i / 64] &= ~(uint64_t(1) << (i % 64));
+                }
+            }
+            inbox[v].clear();
+            inbox[v].shrink_to_fit();
+
+            if (std::all_of(table.begin(), table.end(), [](uint64_t word) { return word == 0; }))
+                return false;  // UNSAT - no assignment of the bag can be extended
+
+            // Project out the eliminated atom and send the table to the neighbour eliminated next
+            if (k == 1) continue;
+            const uint64_t half = assignments / 2;
+            std::vector<uint64_t> projected(std::max<uint64_t>(1, half / 64));
+            if (half >= 64)
+                for (size_t i = 0; i < projected.size(); i++) projected[i] = table[i] | table[i + projected.size()];
+            else
+                projected[0] = (table[0] | (table[0] >> half)) & ((uint64_t(1) << half) - 1);
+
+            int parent = bag[0];
+            for (size_t i = 0; i + 1 < k; i++)
+                if (position[bag[i]] < position[parent]) parent = bag[i];
+            inbox[parent].emplace_back(std::vector<int>(bag.begin(), bag.end() - 1), std::move(projected));
+        }
+
+        return true;
+    }
+};
+
+/**
+* @struct BitsetDP
+* Represents DP elimination specialized for formulas with at most 256 atoms, where a clause is a pair of bitsets.
+*
+* Atoms are renumbered densely and every clause keeps one bit per atom for its positive and one for its negative
+*  literals. Resolution, the tautology test and subsumption then take a few AND, OR and ANDNOT operations on four
+*  words, done with AVX2 when the compiler targets it. Resolvents subsumed by other clauses are dropped and the
+*  clauses they subsume are removed, while unit propagation and pure literals work on all clauses at once.
+*/
+struct BitsetDP {
+    static constexpr size_t maxAtoms = 256;
+    static constexpr size_t words = maxAtoms / 64;
+
+    /**
+    * @struct BitClause
+    * Represents a clause as the bitsets of its positive and its negative literals.
+    */
+    struct alignas(32) BitClause {
+        uint64_t positive[words] = {};
+        uint64_t negative[words] = {};
+    };
+
+    std::vector<Atom> atoms;          // original atom of every bit
+    std::vector<BitClause> clauses;
+    size_t resolventsProduced = 0;
+
+    static bool test(const uint64_t* bits, size_t bit) {
+        return (bits[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    static void set(uint64_t* bits, size_t bit) {
+        bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    static size_t length(const BitClause& clause) {
+        size_t count = 0;
+        for (size_t w = 0; w < words; w++) count += __builtin_popcountll(clause.positive[w]) + __builtin_popcountll(clause.negative[w]);
+        return count;
+    }
+
+#ifdef __AVX2__
+    static __m256i load(const uint64_t* bits) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(bits));
+    }
+
+    static bool isTautology(const BitClause& clause) {
+        const __m256i common = _mm256_and_si256(load(clause.positive), load(clause.negative));
+        return !_mm256_testz_si256(common, common);
+    }
+
+    static bool subsumes(const BitClause& a, const BitClause& b) {
+        const __m256i extra = _mm256_or_si256(_mm256_andnot_si256(load(b.positive), load(a.positive)),
+                                              _mm256_andnot_si256(load(b.negative), load(a.negative)));
+        return _mm256_testz_si256(extra, extra);
+    }
+
+    static BitClause resolve(const BitClause& a, const BitClause& b, const BitClause& pivot) {
+        BitClause result;
+        _mm256_store_si256(reinterpret_cast<__m256i*>(result.positive),
+                           _mm256_andnot_si256(load(pivot.positive), _mm256_or_si256(load(a.positive), load(b.positive))));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(result.negative),
+                           _mm256_andnot_si256(load(pivot.positive), _mm256_or_si256(load(a.negative), load(b.negative))));
+        return result;
+    }
+#else
+    static bool isTautology(const BitClause& clause) {
+        uint64_t common = 0;
+        for (size_t w = 0; w < words; w++) common |= clause.positive[w] & clause.negative[w];
+        return common != 0;
+    }
+
+    static bool subsumes(const BitClause& a, const BitClause& b) {
+        uint64_t extra = 0;
+        for (size_t w = 0; w < words; w++) extra |= (a.positive[w] & ~b.positive[w]) | (a.negative[w] & ~b.negative[w]);
+        return extra == 0;
+    }
+
+    static BitClause resolve(const BitClause& a, const BitClause& b, const BitClause& pivot) {
+        BitClause result;
+        for (size_t w = 0; w < words; w++) {
+            result.positive[w] = (a.positive[w] | b.positive[w]) & ~pivot.positive[w];
+            result.negative[w] = (a.negative[w] | b.negative[w]) & ~pivot.positive[w];
+        }
+        return result;
+    }
+#endif
+
+    /**
+    * @brief Checks if the formula has few enough atoms for the bitset representation.
+    */
+    static bool fits(const NormalForm& f) {
+        std::set<Atom> seen;
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause)
+                if (seen.insert(std::abs(literal)).second && seen.size() > maxAtoms) return false;
+        return true;
+    }
+
+    /**
+    * @brief Converts a clause to its bitsets, using the dense numbering of the atoms.
+    */
+    BitClause toBits(const Clause& clause) const {
+        BitClause bits;
+        for (const Literal& literal : clause) {
+            const size_t bit = std::lower_bound(atoms.begin(), atoms.end(), std::abs(literal)) - atoms.begin();
+            set(literal > 0 ? bits.positive : bits.negative, bit);
+        }
+        return bits;
+    }
+
+    /**
+    * @brief Renumbers the atoms of the formula and converts its clauses, dropping tautologies.
+    *
+    * @param f The normal form of the formula, which must fit.
+    */
+    void load(const NormalForm& f) {
+        atoms.clear();
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause) atoms.push_back(std::abs(literal));
+        std::sort(atoms.begin(), atoms.end());
+        atoms.erase(std::unique(atoms.begin(), atoms.end()), atoms.end());
+
+        clauses.clear();
+        for (const Clause& clause : f) {
+            BitClause bits = toBits(clause);
+            if (!isTautology(bits)) clauses.push_back(bits);
+        }
+    }
+
+    /**
+    * @brief Propagates unit clauses and removes clauses with pure literals until neither applies.
+    *
+    * @return bool False if an empty clause was found, true otherwise.
+    */
+    bool simplify() {
+        for (bool changed = true; changed; ) {
+            changed = false;
+
+            // Literals made true by unit clauses
+            BitClause units;
+            for (const BitClause& clause : clauses) {
+                const size_t size = length(clause);
+                if (size == 0) return false;  // UNSAT - empty clause
+                if (size > 1) continue;
+                for (size_t w = 0; w < words; w++) {
+                    units.positive[w] |= clause.positive[w];
+                    units.negative[w] |= clause.negative[w];
+                }
+            }
+            if (isTautology(units)) return false;  // UNSAT - complementary unit clauses
+
+            if (length(units) > 0) {
+                changed = true;
+                size_t kept = 0;
+                for (BitClause& clause : clauses) {
+                    uint64_t satisfied = 0;
+                    for (size_t w = 0; w < words; w++) {
+                        satisfied |= (clause.positive[w] & units.positive[w]) | (clause.negative[w] & units.negative[w]);
+                        clause.positive[w] &= ~units.negative[w];
+                        clause.negative[w] &= ~units.positive[w];
+                    }
+                    if (satisfied) continue;
+                    if (length(clause) == 0) return false;  // UNSAT - empty clause
+                    clauses[kept++] = clause;
+                }
+                clauses.resize(kept);
+                continue;
+            }
+
+            // Literals whose negation occurs nowhere
+            BitClause occurring, pure;
+            for (const BitClause& clause : clauses)
+                for (size_t w = 0; w < words; w++) {
+                    occurring.positive[w] |= clause.positive[w];
+                    occurring.negative[w] |= clause.negative[w];
+                }
+            for (size_t w = 0; w < words; w++) {
+                pure.positive[w] = occurring.positive[w] & ~occurring.negative[w];
+                pure.negative[w] = occurring.negative[w] & ~occurring.positive[w];
+            }
+
+            if (length(pure) > 0) {
+                changed = true;
+                size_t kept = 0;
+                for (const BitClause& clause : clauses) {
+                    uint64_t hit = 0;
+                    for (size_t w = 0; w < words; w++) hit |= (clause.positive[w] & pure.positive[w]) | (clause.negative[w] & pure.negative[w]);
+                    if (!hit) clauses[kept++] = clause;
+                }
+                clauses.resize(kept);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief Adds a resolvent unless a clause subsumes it, removing the clauses it subsumes.
+    */
+    void addResolvent(const BitClause& resolvent) {
+        for (const BitClause& clause : clauses)
+            if (subsumes(clause, resolvent)) return;
+
+        size_t kept = 0;
+        for (const BitClause& clause : clauses)
+            if (!subsumes(resolvent, clause)) clauses[kept++] = clause;
+        clauses.resize(kept);
+        clauses.push_back(resolvent);
+    }
+
+    /**
+    * @brief Decides the formula by eliminating the atom with the fewest resolvents until no clause is left.
+    *
+    * @return bool True if the formula is satisfiable, false otherwise.
+    */
+    bool solve() {
+        while (true) {
+            if (!simplify()) return false;  // UNSAT - empty clause
+            if (clauses.empty()) return true;  // SAT - formula is empty
+
+            // After simplification every remaining atom occurs with both signs
+            std::vector<size_t> positive(atoms.size(), 0), negative(atoms.size(), 0);
+            for (const BitClause& clause : clauses)
+                for (size_t w = 0; w < words; w++) {
+                    for (uint64_t bits = clause.positive[w]; bits; bits &= bits - 1) positive[64 * w + __builtin_ctzll(bits)]++;
+                    for (uint64_t bits = clause.negative[w]; bits; bits &= bits - 1) negative[64 * w + __builtin_ctzll(bits)]++;
+                }
+
+            size_t best = 0;
+            long bestGrowth = LONG_MAX;
+            for (size_t bit = 0; bit < atoms.size(); bit++) {
+                if (!positive[bit] || !negative[bit]) continue;
+                const long growth = static_cast<long>(positive[bit] * negative[bit]) - static_cast<long>(positive[bit] + negative[bit]);
+                if (growth < bestGrowth) {
+                    bestGrowth = growth;
+                    best = bit;
+                }
+            }
+
+            BitClause pivot;
+            set(pivot.positive, best);
+            std::vector<BitClause> with, without;
+            size_t kept = 0;
+            for (const BitClause& clause : clauses)
+                if (test(clause.positive, best)) with.push_back(clause);
+                else if (test(clause.negative, best)) without.push_back(clause);
+                else clauses[kept++] = clause;
+            clauses.resize(kept);
+
+            for (const BitClause& a : with)
+                for (const BitClause& b : without) {
+                    const BitClause resolvent = resolve(a, b, pivot);
+                    resolventsProduced++;
+                    if (isTautology(resolvent)) continue;
+                    if (length(resolvent) == 0) return false;  // UNSAT - empty clause
+                    addResolvent(resolvent);
+                }
+        }
+    }
+};
+
+/**
+* @struct BatchSolver
+* Represents a solver for streams of many tiny formulas, each starting with its own "p cnf" header.
+*
+* A formula with at most maxAtoms atoms is decided by its truth table: one bit per assignment, 64 assignments
+*  to a word. The six lowest atoms vary inside a word and the others select the word, so a clause masks every
+*  word with the same constant, or keeps it whole when one of its higher literals is true for that word. The loop
+*  over the words has no branches and the compiler vectorizes it. Literals and clauses are kept in flat buffers
+*  reused by all formulas, so the kernel allocates nothing per formula; larger formulas go to BitsetDP or DP.
+*
+* Vector lanes hold the assignments of one formula, so a formula with at most six atoms, whose table is a single
+*  word, is decided by scalar operations. Packing such formulas into adjacent words and ANDing one clause of each
+*  at a time was measured at the same speed or slightly slower: parsing dominates, and the packed clause masks
+*  must be padded to the longest formula.
+*/
+struct BatchSolver {
+    static constexpr size_t maxAtoms = 16;
+    static constexpr size_t tableWords = size_t(1) << (maxAtoms - 6);
+
+    std::vector<Literal> literals;     // literals of all clauses of the current formula
+    std::vector<size_t> clauseEnds;    // end of every clause in literals
+    std::vector<uint32_t> stamp;       // formula in which an atom was last numbered, by atom
+    std::vector<uint32_t> bit;         // dense number of an atom in the current formula, by atom
+    uint32_t formulas = 0;
+    size_t atomCount = 0;
+    size_t tableSolved = 0;
+    alignas(32) uint64_t table[tableWords];
+
+    /**
+    * @brief Gives the dense number of the atom in the current formula, numbering it if it is new.
+    */
+    uint32_t number(Atom atom) {
+        if (static_cast<size_t>(atom) >= stamp.size()) {
+            stamp.resize(std::max(2 * stamp.size(), static_cast<size_t>(atom) + 1), 0);
+            bit.resize(stamp.size(), 0);
+        }
+        if (stamp[atom] != formulas) {
+            stamp[atom] = formulas;
+            bit[atom] = atomCount++;
+        }
+        return bit[atom];
+    }
+
+    /**
+    * @brief Decides the current formula by computing its truth table.
+    *
+    * @return bool True if some assignment satisfies all clauses, false otherwise.
+    */
+    bool evaluate() {
+        static constexpr uint64_t patterns[6] = { 0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+                                                  0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL };
+        const size_t words = atomCount <= 6 ? 1 : size_t(1) << (atomCount - 6);
+        const uint64_t valid = atomCount >= 6 ? ~uint64_t(0) : (uint64_t(1) << (uint64_t(1) << atomCount)) - 1;
+        std::fill(table, table + words, valid);
+
+        size_t begin = 0;
+        for (const size_t end : clauseEnds) {
+            uint64_t low = 0, positive = 0, negative = 0;
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t b = bit[std::abs(literals[i])];
+                if (b < 6) low |= literals[i] > 0 ? patterns[b] : ~patterns[b];
+                else if (literals[i] > 0) positive |= uint64_t(1) << (b - 6);
+                else negative |= uint64_t(1) << (b - 6);
+            }
+            begin = end;
+
+            for (size_t w = 0; w < words; w++)
+                table[w] &= low | -static_cast<uint64_t>(((w & positive) | (~w & negative)) != 0);
+        }
+
+        uint64_t any = 0;
+        for (size_t w = 0; w < words; w++) any |= table[w];
+        return any != 0;
+    }
+
+    /**
+    * @brief Decides the current formula, by its truth table if it is small enough.
+    */
+    bool decide() {
+        if (atomCount <= maxAtoms) {
+            tableSolved++;
+            return evaluate();
+        }
+
+        NormalForm f;
+        size_t begin = 0;
+        for (const size_t end : clauseEnds) {
+            if (begin == end) return false;  // UNSAT - empty clause
+            f.insert(Clause(literals.begin() + begin, literals.begin() + end));
+            begin = end;
+        }
+        if (BitsetDP::fits(f)) {
+            BitsetDP engine;
+            engine.load(f);
+            return engine.solve();
+        }
+        DP solver;
+        return solver.solve(f);
+    }
+
+    /**
+    * @brief Starts a new formula, keeping the capacity of the buffers.
+    */
+    void reset() {
+        literals.clear();
+        clauseEnds.clear();
+        atomCount = 0;
+        formulas++;
+    }
+
+    /**
+    * @brief Decides every formula of the input in order.
+    *
+    * A formula starts at its "p cnf" header and ends at the next one. Comment lines are skipped, as is everything
+    *  from a "%" line to the next header, which ends the files of the SATLIB benchmarks.
+    *
+    * @param input The formulas in the DIMACS format, one after another.
+    * @param onAnswer Called with the answer of every formula.
+    * @return size_t The number of formulas.
+    */
+    size_t solve(const std::string& input, const std::function<void(bool)>& onAnswer) {
+        const char* p = input.data();
+        const char* const end = p + input.size();
+        const size_t first = formulas;
+        bool started = false, skipping = false;
+        reset();
+
+        auto finish = [&]() {
+            if (literals.size() > (clauseEnds.empty() ? 0 : clauseEnds.back())) clauseEnds.push_back(literals.size());  // last clause without 0
+            onAnswer(decide());
+            reset();
+        };
+
+        while (p < end) {
+            if (std::isspace(static_cast<unsigned char>(*p))) {
+                p++;
+                continue;
+            }
+            if (*p == 'p') {
+                if (started) finish();
+                started = true;
+                skipping = false;
+            }
+            if (*p == 'c' || *p == 'p' || *p == '%' || skipping) {
+                if (*p == '%') skipping = true;
+                while (p < end && *p != '\n') p++;
+                continue;
+            }
+
+            const bool negative = *p == '-';
+            if (negative || *p == '+') p++;
+            if (p == end || !std::isdigit(static_cast<unsigned char>(*p))) {
+                p++;
+                continue;
+            }
+            long value = 0;
+            while (p < end && std::isdigit(static_cast<unsigned char>(*p))) value = std::min(10 * value + (*p++ - '0'), long(INT_MAX));
+
+            started = true;
+            if (value == 0) clauseEnds.push_back(literals.size());
+            else {
+                number(value);
+                literals.push_back(negative ? -value : value);
+            }
+        }
+        if (started) finish();
+
+        return formulas - first - 1;
+    }
+};
+
+/**
+* @struct Tuner
+* Represents a driver which races configurations of the solver over a corpus of formulas.
+*
+* Every round runs all remaining configurations on the next formula of the corpus, as parallel child processes
+*  of this program with a timeout, and timed out runs count twice the timeout (PAR-2). From the third round on,
+*  a configuration whose total time exceeds twice the best total is eliminated, so the remaining rounds are spent
+*  on the promising ones. A configuration which answers differently from the majority is eliminated at once.
+*/
+struct Tuner {
+    /**
+    * @struct Configuration
+    * Represents a set of command-line options together with its results so far.
+    */
+    struct Configuration {
+        std::vector<std::string> arguments;
+        std::vector<double> times;      // PAR-2 milliseconds of every formula run so far
+        size_t solved = 0;
+        size_t eliminatedAfter = 0;     // number of rounds before elimination, 0 while racing
+
+        std::string label() const {
+            std::string result;
+            for (const std::string& argument : arguments) result += (result.empty() ? "" : " ") + argument;
+            return result.empty() ? "(defaults)" : result;
+        }
+
+        double total() const {
+            double sum = 0;
+            for (const double time : times) sum += time;
+            return sum;
+        }
+
+        double median() const {
+            if (times.empty()) return 0;
+            std::vector<double> sorted = times;
+            std::sort(sorted.begin(), sorted.end());
+            const size_t middle = sorted.size() / 2;
+            return sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+        }
+    };
+
+    std::string executable;
+    std::vector<std::filesystem::path> corpus;
+    std::vector<Configuration> configurations;
+    double timeout;     // milliseconds
+    size_t jobs;
+    size_t minimumRounds = 3;
+
+    /**
+    * @brief Creates a tuner over all files of the directory, in the order of their names.
+    */
+    Tuner(const std::string& program, const std::filesystem::path& directory, double timeLimit, size_t jobCount)
+        : executable(program), timeout(timeLimit), jobs(std::max<size_t>(jobCount, 1)) {
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(directory, error))
+            if (file.is_regular_file()) corpus.push_back(file.path());
+        std::sort(corpus.begin(), corpus.end());
+    }
+
+    /**
+    * @brief Adds the default grid: the elimination knobs of DP, the Stålmarck preprocessing and the other engines.
+    */
+    void addDefaultConfigurations() {
+        for (const std::string ordering : { "occurrence", "random" })
+            for (const std::string bound : { "", "0", "16" }) {
+                Configuration configuration;
+                configuration.arguments.push_back("--engine=dp");
+                configuration.arguments.push_back("--ordering=" + ordering);
+                if (!bound.empty()) configuration.arguments.push_back("--elimination-bound=" + bound);
+                configurations.push_back(configuration);
+            }
+        for (const std::string engine : { "--stalmarck=1", "--engine=bitset", "--engine=td", "--engine=cdcl", "--engine=auto" }) {
+            Configuration configuration;
+            configuration.arguments.push_back(engine);
+            configurations.push_back(configuration);
+        }
+    }
+
+    /**
+    * @brief Reads configurations, one per line with space-separated options.
+    */
+    void readConfigurations(std::istream& fin) {
+        std::string line;
+        while (std::getline(fin, line)) {
+            Configuration configuration;
+            std::istringstream words(line);
+            std::string argument;
+            while (words >> argument) configuration.arguments.push_back(argument);
+            if (!configuration.arguments.empty()) configurations.push_back(configuration);
+        }
+    }
+
+    /**
+    * @brief Runs every remaining configuration on the formula, at most jobs of them at a time.
+    *
+    * @param formula The path of the formula.
+    */
+    void runRound(const std::filesystem::path& formula) {
+        struct Run {
+            pid_t pid;
+            size_t configuration;
+            std::chrono::steady_clock::time_point start;
+            std::filesystem::path output;
+        };
+
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < configurations.size(); i++)
+            if (!configurations[i].eliminatedAfter) pending.push_back(i);
+
+        std::vector<Run> running;
+        std::vector<std::pair<size_t, std::string>> answers;
+        size_t next = 0;
+        while (next < pending.size() || !running.empty()) {
+            while (running.size() < jobs && next < pending.size()) {
+                const size_t i = pending[next++];
+                const std::filesystem::path output = std::filesystem::temp_directory_path() /
+                    ("dp-tune-" + std::to_string(getpid()) + "-" + std::to_string(i));
+                running.push_back({ spawn(configurations[i].arguments, formula, output), i, std::chrono::steady_clock::now(), output });
+            }
+
+            for (auto it = running.begin(); it != running.end(); ) {
+                int status = 0;
+                pid_t done = it->pid < 0 ? it->pid : waitpid(it->pid, &status, WNOHANG);
+                const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - it->start).count();
+                bool killed = it->pid < 0;
+                if (done == 0 && elapsed > timeout) {
+                    kill(it->pid, SIGKILL);
+                    done = waitpid(it->pid, &status, 0);
+                    killed = true;
+                }
+                if (done == 0) {
+                    ++it;
+                    continue;
+                }
+
+                std::string answer;
+                if (!killed && WIFEXITED(status) && WEXITSTATUS(status) == 0) std::ifstream(it->output) >> answer;
+                std::error_code error;
+                std::filesystem::remove(it->output, error);
+
+                Configuration& configuration = configurations[it->configuration];
+                configuration.times.push_back(answer.empty() ? 2 * timeout : elapsed);
+                if (!answer.empty()) {
+                    configuration.solved++;
+                    answers.emplace_back(it->configuration, answer);
+                }
+                it = running.erase(it);
+            }
+
+            if (!running.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // Configurations disagreeing with the majority are wrong on this formula
+        size_t trueAnswers = 0;
+        for (const auto& [configuration, answer] : answers) trueAnswers += answer == "true";
+        const std::string majority = 2 * trueAnswers >= answers.size() ? "true" : "false";
+        for (const auto& [configuration, answer] : answers)
+            if (answer != majority) {
+                std::cerr << "c tune: " << configurations[configuration].label() << " answers " << answer << " on "
+                          << formula.string() << ", the majority answers " << majority << std::endl;
+                configurations[configuration].eliminatedAfter = configurations[configuration].times.size();
+            }
+    }
+
+    /**
+    * @brief Starts this program with the given options, reading the formula and writing its answer to the output file.
+    *
+    * @return pid_t The process, or -1 if it could not be started.
+    */
+    pid_t spawn(const std::vector<std::string>& arguments, const std::filesystem::path& formula, const std::filesystem::path& output) const {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, 0, formula.c_str(), O_RDONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, 1, output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+
+        std::vector<std::string> words{ executable };
+        words.insert(words.end(), arguments.begin(), arguments.end());
+        std::vector<char*> argv;
+        for (std::string& word : words) argv.push_back(word.data());
+        argv.push_back(nullptr);
+
+        pid_t pid;
+        if (posix_spawn(&pid, executable.c_str(), &actions, nullptr, argv.data(), environ) != 0) pid = -1;
+        posix_spawn_file_actions_destroy(&actions);
+        return pid;
+    }
+
+    /**
+    * @brief Races the configurations over the corpus.
+    *
+    * @return const Configuration* The configuration with the smallest PAR-2 time among those which ran on every formula.
+    */
+    const Configuration* race() {
+        for (size_t round = 0; round < corpus.size(); round++) {
+            runRound(corpus[round]);
+            if (round + 1 < minimumRounds) continue;
+
+            double best = std::numeric_limits<double>::infinity();
+            for (const Configuration& configuration : configurations)
+                if (!configuration.eliminatedAfter) best = std::min(best, configuration.total());
+            for (Configuration& configuration : configurations)
+                if (!configuration.eliminatedAfter && configuration.total() > 2 * best + 10.0 * (round + 1))
+                    configuration.eliminatedAfter = round + 1;
+        }
+
+        const Configuration* winner = nullptr;
+        for (const Configuration& configuration : configurations)
+            if (!configuration.eliminatedAfter && (!winner || configuration.total() < winner->total())) winner = &configuration;
+        return winner;
+    }
+};
+
+/**
+* @brief Measures the cost of creating branches of the formula by copying it and by using snapshots.
+*
+* Every branch removes one clause and adds one new clause, which is a typical amount of change between two decisions.
+*
+* @param f The normal form of the formula.
+* @param branches The number of branches to be created.
+*/
+void benchmarkBranching(const NormalForm& f, int branches) {
+    if (f.empty()) return;
+
+    Literal fresh = 1;
+    for (const Clause& clause : f)
+        for (const Literal& literal : clause)
+            fresh = std::max(fresh, std::abs(literal) + 1);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t copied = 0;
+    for (int i = 0; i < branches; i++) {
+        NormalForm copy = f;
+        copy.erase(copy.begin());
+        copy.insert(Clause{ fresh + i });
+        copied += copy.size();
+    }
+    auto middle = std::chrono::steady_clock::now();
+
+    FormulaSnapshot root(f);
+    size_t shared = 0;
+    for (int i = 0; i < branches; i++) {
+        FormulaSnapshot child = root.branch();
+        child.erase(*f.begin());
+        child.insert(Clause{ fresh + i });
+        shared += child.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Changes undone across branches must restore the formula, while the branches keep seeing them
+    const size_t mark = root.mark();
+    root.erase(*f.begin());
+    root.insert(Clause{ fresh });
+    FormulaSnapshot child = root.branch();
+    root.undo(mark);
+    NormalForm expected = f;
+    expected.erase(expected.begin());
+    expected.insert(Clause{ fresh });
+    const bool consistent = root.materialize() == f && root.size() == f.size() && child.materialize() == expected;
+
+    std::chrono::duration<double, std::milli> copyTime = middle - start, snapshotTime = end - middle;
+    std::cout << "c clauses: " << f.size() << ", branches: " << branches << std::endl;
+    std::cout << "c copy: " << copyTime.count() << " ms (" << copied << " clauses)" << std::endl;
+    std::cout << "c snapshot: " << snapshotTime.count() << " ms (" << shared << " clauses), undo across branches "
+              << (consistent ? "consistent" : "INCONSISTENT") << std::endl;
+}
+
+/**
+* @brief Measures the cost of adding resolvents to the formula one by one and as deduplicated batches of every kind.
+*
+* Every variable of the formula is resolved on, without being eliminated, and its resolvents are added to a copy of the formula.
+*  Batches are measured with 32-bit and, if every atom fits, 16-bit literals, both plain and compressed.
+*
+* @param f The normal form of the formula.
+*/
+void benchmarkResolvents(const NormalForm& f) {
+    DP solver;
+    std::set<Atom> atoms;
+    for (const Clause& clause : f)
+        for (const Literal& literal : clause) atoms.insert(std::abs(literal));
+    const bool narrow = atoms.empty() || *atoms.rbegin() <= narrowAtoms;
+
+    // Plain and compressed batches of both widths, each merged into its own copy of the formula
+    ResolventBatch wide[2];
+    NarrowResolventBatch narrowed[2];
+    NormalForm single = f, wideFormulas[2] = { f, f }, narrowFormulas[2] = { f, f };
+    std::chrono::duration<double, std::milli> singleTime(0), wideTimes[2] = {}, narrowTimes[2] = {};
+    wide[1].compress = narrowed[1].compress = true;
+
+    auto measure = [&](auto& batch, NormalForm& g, const std::vector<Clause>& clausesWith, const std::vector<Clause>& clausesWithout,
+                       Atom atom) {
+        auto start = std::chrono::steady_clock::now();
+        solver.collectResolvents(batch, clausesWith, clausesWithout, atom);
+        solver.mergeResolvents(g, batch);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    };
+
+    size_t produced = 0;
+    for (const Atom& atom : atoms) {
+        auto clausesWith = solver.allClausesWithGivenLiteral(f, atom);
+        auto clausesWithout = solver.allClausesWithGivenLiteral(f, -atom);
+
+        auto start = std::chrono::steady_clock::now();
+        for (const Clause& clause1 : clausesWith)
+            for (const Clause& clause2 : clausesWithout) {
+                Clause resolved = solver.resolve(clause1, clause2, atom);
+                if (!solver.isTautologicClause(resolved)) single.insert(resolved);
+            }
+        singleTime += std::chrono::steady_clock::now() - start;
+
+        for (int compressed = 0; compressed < 2; compressed++) {
+            wideTimes[compressed] += measure(wide[compressed], wideFormulas[compressed], clausesWith, clausesWithout, atom);
+            if (narrow) narrowTimes[compressed] += measure(narrowed[compressed], narrowFormulas[compressed], clausesWith, clausesWithout, atom);
+        }
+        produced += clausesWith.size() * clausesWithout.size();
+    }
+
+    std::cout << "c resolvents: " << produced << ", clauses after merging: " << single.size() << std::endl;
+    std::cout << "c per-insert: " << singleTime.count() << " ms" << std::endl;
+    for (int compressed = 0; compressed < 2; compressed++) {
+        const std::string kind = compressed ? " compressed" : "";
+        std::cout << "c batch" << kind << ": " << wideTimes[compressed].count() << " ms, largest batch "
+                  << wide[compressed].peakMemory << " bytes" << std::endl;
+        if (narrow)
+            std::cout << "c 16-bit batch" << kind << ": " << narrowTimes[compressed].count() << " ms, largest batch "
+                      << narrowed[compressed].peakMemory << " bytes" << std::endl;
+    }
+}
+
+/**
+* @brief Compares resolution, tautology checks and subsumption on clause sets and on bitsets, then whole solving.
+*
+* Every atom is resolved on against the original formula, and every resolvent is tested for being a tautology
+*  and for subsuming its first antecedent, the operations elimination spends its time in.
+*
+* @param f The normal form of the formula, with at most 256 atoms.
+*/
+void benchmarkBitset(const NormalForm& f) {
+    if (!BitsetDP::fits(f)) {
+        std::cout << "c bitset: more than " << BitsetDP::maxAtoms << " atoms" << std::endl;
+        return;
+    }
+
+    DP solver;
+    BitsetDP engine;
+    engine.load(f);
+
+    std::chrono::duration<double, std::milli> generalTime(0), bitsetTime(0);
+    size_t pairs = 0, generalKept = 0, bitsetKept = 0;
+    for (size_t bit = 0; bit < engine.atoms.size(); bit++) {
+        const Atom atom = engine.atoms[bit];
+        auto clausesWith = solver.allClausesWithGivenLiteral(f, atom);
+        auto clausesWithout = solver.allClausesWithGivenLiteral(f, -atom);
+        std::vector<BitsetDP::BitClause> with, without;
+        for (const Clause& clause : clausesWith) with.push_back(engine.toBits(clause));
+        for (const Clause& clause : clausesWithout) without.push_back(engine.toBits(clause));
+
+        auto start = std::chrono::steady_clock::now();
+        for (const Clause& clause1 : clausesWith)
+            for (const Clause& clause2 : clausesWithout) {
+                Clause resolved = solver.resolve(clause1, clause2, atom);
+                if (!solver.isTautologicClause(resolved) && !std::includes(clause1.begin(), clause1.end(), resolved.begin(), resolved.end()))
+                    generalKept++;
+            }
+        auto middle = std::chrono::steady_clock::now();
+
+        BitsetDP::BitClause pivot;
+        BitsetDP::set(pivot.positive, bit);
+        for (const BitsetDP::BitClause& clause1 : with)
+            for (const BitsetDP::BitClause& clause2 : without) {
+                const BitsetDP::BitClause resolved = BitsetDP::resolve(clause1, clause2, pivot);
+                if (!BitsetDP::isTautology(resolved) && !BitsetDP::subsumes(resolved, clause1)) bitsetKept++;
+            }
+        auto end = std::chrono::steady_clock::now();
+
+        generalTime += middle - start;
+        bitsetTime += end - middle;
+        pairs += clausesWith.size() * clausesWithout.size();
+    }
+
+    std::cout << "c pairs: " << pairs << ", kept: " << generalKept << " general, " << bitsetKept << " bitset" << std::endl;
+    std::cout << "c general: " << generalTime.count() << " ms, " << pairs / std::max(generalTime.count(), 1e-6) * 1e3 << " pairs/s" << std::endl;
+    std::cout << "c bitset: " << bitsetTime.count() << " ms, " << pairs / std::max(bitsetTime.count(), 1e-6) * 1e3 << " pairs/s" << std::endl;
+
+    NormalForm copy = f;
+    auto start = std::chrono::steady_clock::now();
+    const bool generalAnswer = solver.solve(copy);
+    auto middle = std::chrono::steady_clock::now();
+    const bool bitsetAnswer = engine.solve();
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "c solve general: " << std::chrono::duration<double, std::milli>(middle - start).count() << " ms ("
+              << (generalAnswer ? "true" : "false") << ")" << std::endl;
+    std::cout << "c solve bitset: " << std::chrono::duration<double, std::milli>(end - middle).count() << " ms ("
+              << (bitsetAnswer ? "true" : "false") << ", " << engine.resolventsProduced << " resolvents)" << std::endl;
+}
+
+/**
+* @brief Measures the subsumption pass with one thread and with more, checking that both give the same formula.
+*
+* @param f The normal form of the formula.
+* @param threads The largest number of threads.
+*/
+void benchmarkSubsumption(const NormalForm& f, size_t threads) {
+    NormalForm reference;
+    for (size_t count = 1; ; count = std::min(2 * count, threads)) {
+        DP solver;
+        NormalForm copy = f;
+        Subsumption pass(solver, copy, count);
+        auto start = std::chrono::steady_clock::now();
+        const bool consistent = pass.run();
+        std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+        if (count == 1) reference = copy;
+
+        std::cout << "c threads " << count << ": " << time.count() << " ms, " << pass.subsumed << " subsumed, " << pass.strengthened
+                  << " strengthened in " << pass.rounds << " rounds, " << copy.size() << " clauses left"
+                  << (consistent ? "" : ", empty clause") << (copy == reference ? "" : ", DIFFERENT from one thread") << std::endl;
+        if (count == threads) break;
+    }
+}
+
+/**
+* @brief Measures the number of formulas per second decided by truth tables in a batch and by DP one by one.
+*
+* @param input Formulas in the DIMACS format, each starting with its own "p cnf" header.
+*/
+void benchmarkBatch(const std::string& input) {
+    BatchSolver batch;
+    std::vector<bool> batchAnswers;
+    auto start = std::chrono::steady_clock::now();
+    const size_t count = batch.solve(input, [&batchAnswers](bool answer) { batchAnswers.push_back(answer); });
+    std::chrono::duration<double, std::milli> batchTime = std::chrono::steady_clock::now() - start;
+
+    // Every formula ends where the next header starts
+    std::vector<size_t> headers;
+    for (size_t position = 0; position < input.size(); ) {
+        const size_t first = input.find_first_not_of(" \t", position);
+        if (first != std::string::npos && input[first] == 'p') headers.push_back(position);
+        const size_t newline = input.find('\n', position);
+        position = newline == std::string::npos ? input.size() : newline + 1;
+    }
+    if (headers.empty()) headers.push_back(0);
+    else headers.front() = 0;  // comments before the first header
+
+    size_t disagreements = 0;
+    std::chrono::duration<double, std::milli> generalTime(0);
+    for (size_t i = 0; i < headers.size() && i < batchAnswers.size(); i++) {
+        const size_t end = i + 1 < headers.size() ? headers[i + 1] : input.size();
+        std::istringstream fin(input.substr(headers[i], end - headers[i]));
+
+        start = std::chrono::steady_clock::now();
+        DP solver;
+        NormalForm f = solver.parse(fin);
+        const bool answer = !solver.parseConflict && solver.solve(f);
+        generalTime += std::chrono::steady_clock::now() - start;
+        if (answer != batchAnswers[i]) disagreements++;
+    }
+
+    std::cout << "c formulas: " << count << ", " << batch.tableSolved << " by truth tables, "
+              << disagreements << " disagreements" << std::endl;
+    std::cout << "c batch: " << batchTime.count() << " ms, " << count / std::max(batchTime.count(), 1e-6) * 1e3 << " formulas/s" << std::endl;
+    std::cout << "c general: " << generalTime.count() << " ms, " << count / std::max(generalTime.count(), 1e-6) * 1e3
+              << " formulas/s" << std::endl;
+}
+
+/**
+* @brief Measures the time needed to parse the formula with and without preallocation from the header.
+*
+* @param input The whole input in the DIMACS format.
+* @param repetitions The number of times the input is parsed with each setting.
+*/
+void benchmarkParsing(const std::string& input, int repetitions) {
+    for (bool preallocate : { false, true }) {
+        std::chrono::duration<double, std::milli> total(0);
+        size_t clauses = 0;
+        for (int i = 0; i < repetitions; i++) {
+            DP solver;
+            solver.preallocate = preallocate;
+            std::istringstream fin(input);
+
+            auto start = std::chrono::steady_clock::now();
+            clauses = solver.parse(fin).size();
+            total += std::chrono::steady_clock::now() - start;
+        }
+
+        std::cout << "c " << (preallocate ? "preallocated" : "growing") << ": "
+                  << total.count() / repetitions << " ms per parse (" << clauses << " clauses)" << std::endl;
+    }
+}
+
+/**
+* @brief Checks the copy-on-write snapshots against plain copies of the formula.
+*
+* Random clauses are added and removed, marks are taken and undone and branches are created, always on a random
+*  one of at most eight live snapshots. Every change is repeated on a plain copy kept next to the snapshot, and after every
+*  step the snapshot must represent the same formula.
+*
+* @param f The normal form of the formula.
+* @return bool True if every snapshot matched its copy, false otherwise.
+*/
+bool checkSnapshots(const NormalForm& f) {
+    std::mt19937 random(1);
+    std::vector<Clause> pool(f.begin(), f.end());
+    Literal fresh = 1;
+    for (const Clause& clause : f)
+        for (const Literal& literal : clause) fresh = std::max(fresh, std::abs(literal) + 1);
+    for (int i = 0; i < 8; i++) pool.push_back(Clause{ fresh + i });
+
+    /**
+    * @struct Checked
+    * A snapshot together with the plain copy it must match and the copies at its marks.
+    */
+    struct Checked {
+        FormulaSnapshot snapshot;
+        NormalForm expected;
+        std::vector<std::pair<size_t, NormalForm>> marks;
+    };
+    std::vector<Checked> live;
+    live.push_back({ FormulaSnapshot(f), f, {} });
+
+    for (int step = 0; step < 1000; step++) {
+        const size_t index = random() % live.size();
+        Checked& checked = live[index];
+        const Clause& clause = pool[random() % pool.size()];
+        bool agrees = true;
+        switch (random() % 5) {
+        case 0:
+            agrees = checked.snapshot.insert(clause) == checked.expected.insert(clause).second;
+            break;
+        case 1:
+            agrees = checked.snapshot.erase(clause) == (checked.expected.erase(clause) != 0);
+            break;
+        case 2:
+            checked.marks.emplace_back(checked.snapshot.mark(), checked.expected);
+            break;
+        case 3:
+            if (!checked.marks.empty()) {
+                const size_t mark = random() % checked.marks.size();
+                checked.snapshot.undo(checked.marks[mark].first);
+                checked.expected = checked.marks[mark].second;
+                checked.marks.resize(mark + 1);
+            }
+            break;
+        default: {
+            // Once there are enough snapshots, the child replaces a random one, possibly its parent
+            Checked child{ checked.snapshot.branch(), checked.expected, {} };
+            if (live.size() < 8) live.push_back(std::move(child));
+            else live[random() % live.size()] = std::move(child);
+        }
+        }
+
+        const Checked& changed = live[index];
+        if (!agrees || changed.snapshot.size() != changed.expected.size() || changed.snapshot.materialize() != changed.expected)
+            return false;
+    }
+
+    return std::all_of(live.begin(), live.end(), [](const Checked& checked) { return checked.snapshot.materialize() == checked.expected; });
+}
+
+/**
+* @brief Checks that probing literals undoes all its changes through the trail and implies what plain propagation does.
+*
+* Every probe is repeated without the trail on a fresh solver, which adds the literal as a unit clause, propagates it
+*  and, in the second round, removes pure literals. The literals which became true and the conflict must be the same,
+*  and after the probe the formula and the false literals must be as before. A third round probes while solving,
+*  where the undo goes through the bookkeeping of the passes, and the occurrence counts must match the formula.
+*
+* @param input The whole input in the DIMACS format.
+* @return bool True if every probe matched, false otherwise.
+*/
+bool checkProbes(const std::string& input) {
+    DP solver;
+    std::istringstream fin(input);
+    NormalForm f = solver.parse(fin);
+    if (solver.parseConflict) return true;
+
+    const NormalForm original = f;
+    const std::set<Literal> originalFalse = solver.falseLiterals;
+    const std::vector<Literal> probed(solver.literals.begin(), solver.literals.end());
+    for (bool pureLiterals : { false, true })
+        for (size_t i = 0; i < probed.size() && i < 64; i++) {
+            std::vector<Literal> implied;
+            const bool conflict = solver.probe(f, probed[i], implied, pureLiterals);
+            if (f != original || solver.falseLiterals != originalFalse) return false;
+
+            DP reference;
+            std::istringstream again(input);
+            NormalForm g = reference.parse(again);
+            bool referenceConflict = false;
+            if (reference.falseLiterals.count(probed[i])) referenceConflict = true;
+            else {
+                reference.insertClause(g, Clause{ probed[i] });
+                reference.removeUnitClauses(g, referenceConflict);
+                if (!referenceConflict && pureLiterals) reference.removePureClauses(g);
+            }
+            if (conflict != referenceConflict) return false;
+            if (conflict) continue;
+
+            std::set<Literal> expected;
+            for (const Literal& literal : reference.falseLiterals)
+                if (!originalFalse.count(literal)) expected.insert(-literal);
+            if (std::set<Literal>(implied.begin(), implied.end()) != expected) return false;
+        }
+
+    solver.startSolving(f);
+    for (size_t i = 0; i < probed.size() && i < 64; i++) {
+        std::vector<Literal> implied;
+        solver.probe(f, probed[i], implied, true);
+
+        std::vector<size_t> counted(solver.occurrences.size(), 0);
+        for (const Clause& clause : f)
+            for (const Literal& literal : clause) counted[DP::literalIndex(literal)]++;
+        if (counted != solver.occurrences || solver.liveClauses.size() != f.size()) return false;
+    }
+
+    return true;
+}
+
+/**
+* @brief Checks that every kind of resolvent batch merges into the formula what adding the resolvents one by one does.
+*
+* Every atom is resolved on against the original formula, as in benchmarkResolvents(), and the batches of both
+*  widths, plain and compressed, are deduplicated and merged into their own copies of the formula. Since the merge
+*  into a set would hide duplicates, every resolvent is also added twice to each kind of batch, and deduplication
+*  must keep exactly one copy of each distinct resolvent.
+*
+* @param f The normal form of the formula.
+* @return bool True if all copies are equal after every atom, false otherwise.
+*/
+bool checkResolvents(const NormalForm& f) {
+    DP solver;
+    std::set<Atom> atoms;
+    for (const Clause& clause : f)
+        for (const Literal& literal : clause) atoms.insert(std::abs(literal));
+    const bool narrow = atoms.empty() || *atoms.rbegin() <= narrowAtoms;
+
+    ResolventBatch wide[2];
+    NarrowResolventBatch narrowed[2];
+    NormalForm single = f, wideFormulas[2] = { f, f }, narrowFormulas[2] = { f, f };
+    wide[1].compress = narrowed[1].compress = true;
+
+    auto deduplicatesTwice = [](auto& batch, const std::vector<Clause>& clausesWith, const std::vector<Clause>& clausesWithout,
+                                Atom atom, size_t distinct) {
+        batch.clear();
+        for (int copy = 0; copy < 2; copy++)
+            for (const Clause& clause1 : clausesWith)
+                for (const Clause& clause2 : clausesWithout) batch.addResolvent(clause1, clause2, atom);
+        return batch.deduplicate().size() == distinct;
+    };
+
+    for (const Atom& atom : atoms) {
+        auto clausesWith = solver.allClausesWithGivenLiteral(f, atom);
+        auto clausesWithout = solver.allClausesWithGivenLiteral(f, -atom);
+        std::set<Clause> distinct;
+        for (const Clause& clause1 : clausesWith)
+            for (const Clause& clause2 : clausesWithout) {
+                Clause resolved = solver.resolve(clause1, clause2, atom);
+                if (!solver.isTautologicClause(resolved)) distinct.insert(resolved);
+            }
+        single.insert(distinct.begin(), distinct.end());
+
+        // A batch stops at the empty resolvent, which the one by one insertion must have found as well
+        const bool empty = single.count(Clause()) != 0;
+        for (int compressed = 0; compressed < 2; compressed++) {
+            if (!deduplicatesTwice(wide[compressed], clausesWith, clausesWithout, atom, distinct.size())) return false;
+            if (!solver.collectResolvents(wide[compressed], clausesWith, clausesWithout, atom)) return empty;
+            solver.mergeResolvents(wideFormulas[compressed], wide[compressed]);
+            if (wideFormulas[compressed] != single) return false;
+            if (!narrow) continue;
+            if (!deduplicatesTwice(narrowed[compressed], clausesWith, clausesWithout, atom, distinct.size())) return false;
+            if (!solver.collectResolvents(narrowed[compressed], clausesWith, clausesWithout, atom)) return empty;
+            solver.mergeResolvents(narrowFormulas[compressed], narrowed[compressed]);
+            if (narrowFormulas[compressed] != single) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+* @brief Checks the clause trie against a plain set of clauses.
+*
+* Random clauses of the formula are inserted and erased, and after every step the trie must hold the same clauses,
+*  use one node per distinct prefix, and answer subsumption queries as a scan of the set does. The queries are
+*  clauses of the formula with a random literal dropped or with a literal of another clause added.
+*
+* @param f The normal form of the formula.
+* @return bool True if the trie matched the set after every step, false otherwise.
+*/
+bool checkTrie(const NormalForm& f) {
+    std::mt19937 random(1);
+    std::vector<Clause> pool(f.begin(), f.end());
+    std::shuffle(pool.begin(), pool.end(), random);
+    if (pool.size() > 256) pool.resize(256);
+    if (pool.empty()) return true;
+
+    ClauseTrie trie;
+    std::set<Clause> expected;
+    auto pick = [&random](size_t size) { return std::uniform_int_distribution<size_t>(0, size - 1)(random); };
+    for (int step = 0; step < 1000; step++) {
+        const Clause& clause = pool[pick(pool.size())];
+        if (random() % 3 == 0) {
+            if (trie.erase(clause.begin(), clause.end()) != (expected.erase(clause) != 0)) return false;
+        } else if (trie.insert(clause.begin(), clause.end()) != expected.insert(clause).second) return false;
+
+        std::set<std::vector<Literal>> prefixes;
+        for (const Clause& present : expected)
+            for (auto it = present.begin(); it != present.end(); ) prefixes.emplace(present.begin(), ++it);
+        if (trie.size() != expected.size() || trie.nodeCount() != prefixes.size() + 1) return false;
+
+        for (int query = 0; query < 4; query++) {
+            Clause queried = pool[pick(pool.size())];
+            if (!queried.empty() && random() % 2) queried.erase(std::next(queried.begin(), pick(queried.size())));
+            else {
+                const Clause& other = pool[pick(pool.size())];
+                if (!other.empty()) queried.insert(*std::next(other.begin(), pick(other.size())));
+            }
+            if (trie.contains(queried.begin(), queried.end()) != (expected.count(queried) != 0)) return false;
+
+            const std::vector<Literal> literals(queried.begin(), queried.end());
+            bool subsumed = false;
+            std::vector<Clause> supersets;
+            for (const Clause& present : expected) {
+                subsumed = subsumed || std::includes(queried.begin(), queried.end(), present.begin(), present.end());
+                if (std::includes(present.begin(), present.end(), queried.begin(), queried.end())) supersets.push_back(present);
+            }
+            std::vector<Clause> found = trie.subsumedBy(literals.data(), literals.size());
+            std::sort(found.begin(), found.end());
+            if (trie.subsumes(literals.data(), literals.size()) != subsumed || found != supersets) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+* @brief Checks that parsing with preallocation from the header gives the same formula and state as without it.
+*
+* @param input The whole input in the DIMACS format.
+* @return bool True if both parses agree, false otherwise.
+*/
+bool checkParsing(const std::string& input) {
+    DP preallocated, growing;
+    growing.preallocate = false;
+    std::istringstream first(input), second(input);
+    const NormalForm f = preallocated.parse(first), g = growing.parse(second);
+    return f == g && preallocated.literals == growing.literals && preallocated.falseLiterals == growing.falseLiterals &&
+           preallocated.maxAtom == growing.maxAtom && preallocated.parseConflict == growing.parseConflict;
+}
+
+/**
+* @brief Checks the internal data structures on the formula and reports every check on the standard output.
+*
+* @param input The whole input in the DIMACS format.
+* @return bool True if all checks passed, false otherwise.
+*/
+bool checkStructures(const std::string& input) {
+    DP solver;
+    std::istringstream fin(input);
+    const NormalForm f = solver.parse(fin);
+
+    bool passed = true;
+    auto report = [&passed](const char* name, bool ok) {
+        std::cout << "c check " << name << ": " << (ok ? "ok" : "MISMATCH") << std::endl;
+        passed = passed && ok;
+    };
+    report("parse", checkParsing(input));
+    report("snapshots", checkSnapshots(f));
+    report("trail", checkProbes(input));
+    report("resolvents", checkResolvents(f));
+    report("trie", checkTrie(f));
+    return passed;
+}
+
+/**
+* @struct MemoryBuffer
+* Represents a stream buffer reading directly from memory, so a file read into memory is parsed without a copy.
+*/
+struct MemoryBuffer : std::streambuf {
+    MemoryBuffer(char* data, size_t size) {
+        setg(data, data, data + size);
+    }
+};
+
+/**
+* @struct InputReader
+* Represents an input layer reading many files at once, handing every file to a callback as soon as it is read.
+*
+* On Linux the files are read through io_uring, set up with raw system calls: up to depth reads of at most
+*  chunkSize bytes are kept in flight over several files, so the device always has work queued while the callback
+*  parses the files already completed. Where io_uring is unavailable, the files are read one by one with blocking reads.
+*/
+struct InputReader {
+    size_t depth = 16;
+    size_t chunkSize = 1 << 20;
+    bool asynchronous = true;       // try io_uring first
+    bool usedUring = false;
+    uint64_t bytes = 0;
+
+    using Callback = std::function<void(const std::string& path, std::string& data)>;
+
+    /**
+    * @brief Reads the file with blocking reads.
+    *
+    * @return bool True if the file was read, false otherwise.
+    */
+    static bool readFile(const std::string& path, std::string& data) {
+        std::ifstream fin(path, std::ios::binary | std::ios::ate);
+        if (!fin) return false;
+        data.resize(fin.tellg());
+        fin.seekg(0);
+        return static_cast<bool>(fin.read(data.data(), data.size()));
+    }
+
+    /**
+    * @brief Reads all files, handing each to the callback in the order the reads complete.
+    *
+    * @param paths The files to read.
+    * @param onFile Called with the path and the contents of every file, which it may take over.
+    */
+    void read(const std::vector<std::string>& paths, const Callback& onFile) {
+        bytes = 0;
+        usedUring = false;
+#ifdef DP_HAVE_IO_URING
+        if (asynchronous && readWithUring(paths, onFile)) {
+            usedUring = true;
+            return;
+        }
+#endif
+        readBlocking(paths.begin(), paths.end(), onFile);
+    }
+
+    /**
+    * @brief Reads the files one by one with blocking reads.
+    */
+    template <typename Iterator>
+    void readBlocking(Iterator first, Iterator last, const Callback& onFile) {
+        for (; first != last; ++first) {
+            std::string data;
+            if (!readFile(*first, data)) {
+                std::cerr << "Cannot read " << *first << std::endl;
+                continue;
+            }
+            bytes += data.size();
+            onFile(*first, data);
+        }
+    }
+
+#ifdef DP_HAVE_IO_URING
+    /**
+    * @struct Slot
+    * Represents a file being read through io_uring.
+    */
+    struct Slot {
+        std::string path;
+        int fd = -1;
+        std::string data;
+        size_t queued = 0;      // bytes for which reads were queued
+        size_t done = 0;        // bytes read
+        unsigned inFlight = 0;
+        bool failed = false;
+    };
+
+    /**
+    * @struct Ring
+    * Represents the submission and completion queues of an io_uring instance, mapped into memory.
+    */
+    struct Ring {
+        std::vector<Slot> retained;     // slots the kernel may still read into, freed only after the ring is closed
+        int fd = -1;
+        unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+        unsigned *cqHead, *cqTail, *cqMask;
+        io_uring_sqe* sqes;
+        io_uring_cqe* cqes;
+        void* sqRing = MAP_FAILED;
+        void* cqRing = MAP_FAILED;
+        size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+
+        /**
+        * @brief Creates the ring with the given number of entries.
+        *
+        * @return bool True if io_uring is available, false otherwise.
+        */
+        bool setup(unsigned entries) {
+            io_uring_params params{};
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0) return false;
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) return false;
+            cqRing = single ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) return false;
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqesMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqesMemory == MAP_FAILED) return false;
+
+            char* sq = static_cast<char*>(sqRing);
+            char* cq = static_cast<char*>(cqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            sqes = static_cast<io_uring_sqe*>(sqesMemory);
+            return true;
+        }
+
+        /**
+        * @brief Unmaps the queues and closes the ring; the retained slots are freed afterwards, with the other members.
+        */
+        ~Ring() {
+            if (sqesSize && sqes) munmap(sqes, sqesSize);
+            if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+            if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+            if (fd >= 0) close(fd);
+        }
+
+        /**
+        * @brief Queues a read of the file into the buffer, to be submitted by the next enter().
+        */
+        void queueRead(int file, char* buffer, unsigned length, uint64_t offset, uint64_t userData) {
+            const unsigned tail = *sqTail;
+            const unsigned index = tail & *sqMask;
+            io_uring_sqe& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = file;
+            sqe.addr = reinterpret_cast<uint64_t>(buffer);
+            sqe.len = length;
+            sqe.off = offset;
+            sqe.user_data = userData;
+            sqArray[index] = index;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        /**
+        * @brief Submits the queued reads and waits until at least the given number of reads complete.
+        */
+        int enter(unsigned wait) {
+            const unsigned pending = *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, pending, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+        }
+
+        /**
+        * @brief Takes back the reads queued but not submitted yet, which the kernel has not seen, passing the user data
+        *  of each to the callback.
+        */
+        template <typename F>
+        void withdraw(F&& onRead) {
+            const unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            for (unsigned i = head; i != *sqTail; i++) onRead(sqes[sqArray[i & *sqMask]].user_data);
+            __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+        }
+
+        /**
+        * @brief Takes the next completion, if there is one.
+        */
+        bool complete(uint64_t& userData, int& result) {
+            const unsigned head = *cqHead;
+            if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            userData = cqe.user_data;
+            result = cqe.res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+    };
+
+    /**
+    * @brief Reads the files through io_uring, keeping up to depth reads in flight.
+    *
+    * Every open file has a slot, and the user data of a read is its slot and its offset in the file.
+    *  A short read is continued by a new read of the rest, and a file whose reads fail is read again with blocking reads.
+    *  No buffer is released while a read into it may still be in the kernel: if the ring fails or the callback throws,
+    *  the reads in flight are taken back or waited for first.
+    *
+    * @return bool False if io_uring is unavailable, before any file was handed over, true otherwise.
+    */
+    bool readWithUring(const std::vector<std::string>& paths, const Callback& onFile) {
+        Ring ring;
+        if (!ring.setup(static_cast<unsigned>(depth))) return false;
+
+        std::vector<Slot> slots(depth);
+        std::vector<size_t> freeSlots;
+        for (size_t i = depth; i-- > 0; ) freeSlots.push_back(i);
+        size_t next = 0, inFlight = 0, open = 0;
+
+        auto finish = [&](Slot& slot) {
+            close(slot.fd);
+            slot.fd = -1;
+            open--;
+            if (slot.failed && !readFile(slot.path, slot.data)) std::cerr << "Cannot read " << slot.path << std::endl;
+            else {
+                bytes += slot.data.size();
+                onFile(slot.path, slot.data);
+            }
+            std::string().swap(slot.data);
+            freeSlots.push_back(&slot - slots.data());
+        };
+
+        // Takes back the reads not submitted yet and waits for the others. If even waiting fails, the buffers are handed
+        //  to the ring, which frees them only after closing its descriptor, since the kernel may still write into them.
+        auto drain = [&]() {
+            ring.withdraw([&](uint64_t userData) {
+                slots[userData >> 48].inFlight--;
+                inFlight--;
+            });
+            uint64_t userData;
+            int result;
+            while (inFlight > 0) {
+                while (ring.complete(userData, result)) {
+                    slots[userData >> 48].inFlight--;
+                    inFlight--;
+                }
+                if (inFlight > 0 && ring.enter(1) < 0 && errno != EINTR) {
+                    ring.retained = std::move(slots);
+                    slots.clear();
+                    return;
+                }
+            }
+        };
+
+        // Stops using the ring, returning the paths of the files still open, which have not been handed over
+        auto abandon = [&]() {
+            std::vector<std::string> unfinished;
+            std::vector<int> files;
+            for (Slot& slot : slots)
+                if (slot.fd >= 0) {
+                    unfinished.push_back(slot.path);
+                    files.push_back(slot.fd);
+                }
+            drain();
+            for (int file : files) close(file);
+            return unfinished;
+        };
+
+        try {
+            while (next < paths.size() || open > 0) {
+                // Open new files while there are free slots
+                while (next < paths.size() && !freeSlots.empty()) {
+                    Slot& slot = slots[freeSlots.back()];
+                    slot.path = paths[next++];
+                    slot.fd = ::open(slot.path.c_str(), O_RDONLY);
+                    struct stat status;
+                    if (slot.fd < 0 || fstat(slot.fd, &status) != 0) {
+                        std::cerr << "Cannot read " << slot.path << std::endl;
+                        if (slot.fd >= 0) close(slot.fd);
+                        continue;
+                    }
+                    freeSlots.pop_back();
+                    open++;
+                    slot.data.resize(status.st_size);
+                    slot.queued = slot.done = 0;
+                    slot.inFlight = 0;
+                    slot.failed = false;
+                    if (slot.data.empty()) finish(slot);
+                }
+
+                // Queue chunks of the open files, as many as the ring holds
+                for (size_t i = 0; i < slots.size() && inFlight < depth; i++) {
+                    Slot& slot = slots[i];
+                    while (slot.fd >= 0 && !slot.failed && slot.queued < slot.data.size() && inFlight < depth) {
+                        const size_t length = std::min(chunkSize, slot.data.size() - slot.queued);
+                        ring.queueRead(slot.fd, &slot.data[slot.queued], length, slot.queued, (uint64_t(i) << 48) | slot.queued);
+                        slot.queued += length;
+                        slot.inFlight++;
+                        inFlight++;
+                    }
+                }
+                if (inFlight == 0) continue;
+
+                if (ring.enter(1) < 0 && errno != EINTR) {
+                    // The ring cannot be used after all: read the open files and the rest with blocking reads
+                    const std::vector<std::string> unfinished = abandon();
+                    readBlocking(unfinished.begin(), unfinished.end(), onFile);
+                    readBlocking(paths.begin() + next, paths.end(), onFile);
+                    return true;
+                }
+
+                uint64_t userData;
+                int result;
+                while (ring.complete(userData, result)) {
+                    Slot& slot = slots[userData >> 48];
+                    const size_t offset = userData & ((uint64_t(1) << 48) - 1);
+                    slot.inFlight--;
+                    inFlight--;
+                    if (result <= 0) slot.failed = true;  // an error, or the file shrank
+                    else {
+                        slot.done += result;
+                        const size_t length = std::min(chunkSize, slot.data.size() - offset);
+                        if (static_cast<size_t>(result) < length) {
+                            // Short read: read the rest of the chunk
+                            ring.queueRead(slot.fd, &slot.data[offset + result], length - result, offset + result,
+                                           (userData >> 48 << 48) | (offset + result));
+                            slot.inFlight++;
+                            inFlight++;
+                            ring.enter(0);
+                        }
+                    }
+                    if (slot.inFlight == 0 && (slot.failed || slot.done == slot.data.size())) finish(slot);
+                }
+            }
+        } catch (...) {
+            abandon();
+            throw;
+        }
+
+        return true;
+    }
+#endif
+};
+
+/**
+* @brief Computes a fingerprint of the formula which does not depend on how it was written down.
+*
+* Atoms are renamed to 1..n by an invariant of the formula: the number of positive occurrences, then the number
+*  of negative occurrences, then the total length of the clauses the atom occurs in. Every clause is hashed on its
+*  own, the hash is passed through the splitmix64 finalizer and the results are combined by addition, so the order
+*  of clauses and literals does not matter. Duplicate clauses and literals are already gone, since the normal form
+*  is a set of sets.
+*
+* Atoms with equal invariants are ordered by their original numbers, so formulas which differ by a permutation of
+*  such atoms can still get different fingerprints. This only costs a cache miss; equal fingerprints always mean
+*  equal formulas after renaming, up to hash collisions.
+*
+* @param f The normal form of the formula.
+* @param atoms Filled with the original atom of every renamed atom, the atom renamed to k is atoms[k - 1].
+* @return std::string The fingerprint as 32 hexadecimal digits.
+*/
+std::string formulaFingerprint(const NormalForm& f, std::vector<Atom>& atoms) {
+    auto mix = [](uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    };
+
+    // Positive occurrences, negative occurrences and the total length of the clauses, for every atom
+    std::unordered_map<Atom, std::array<size_t, 3>> invariants;
+    for (const Clause& clause : f)
+        for (const Literal& literal : clause) {
+            std::array<size_t, 3>& invariant = invariants[std::abs(literal)];
+            invariant[literal > 0 ? 0 : 1]++;
+            invariant[2] += clause.size();
+        }
+
+    atoms.clear();
+    for (const auto& [atom, invariant] : invariants) atoms.push_back(atom);
+    std::sort(atoms.begin(), atoms.end(), [&invariants](const Atom& a, const Atom& b) {
+        const std::array<size_t, 3>& first = invariants.at(a);
+        const std::array<size_t, 3>& second = invariants.at(b);
+        return first != second ? first < second : a < b;
+    });
+
+    std::unordered_map<Atom, uint64_t> renamed;
+    for (size_t i = 0; i < atoms.size(); i++) renamed[atoms[i]] = i + 1;
+    auto rename = [&renamed](const Literal& literal) -> uint64_t {
+        return 2 * renamed.at(std::abs(literal)) + (literal < 0);
+    };
+
+    uint64_t first = mix(f.size()), second = mix(atoms.size() ^ 0x5bd1e995ULL);
+    for (const Clause& clause : f) {
+        std::vector<uint64_t> codes;
+        for (const Literal& literal : clause) codes.push_back(rename(literal));
+        std::sort(codes.begin(), codes.end());
+
+        uint64_t hash = codes.size();
+        for (uint64_t code : codes) hash = mix(hash ^ code);
+        first += mix(hash);
+        second += mix(hash ^ 0x2545f4914f6cdd1dULL);
+    }
+
+    char buffer[33];
+    std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(first),
+                  static_cast<unsigned long long>(second));
+    return buffer;
+}
+
+/**
+* @struct ResultCache
+* Represents an on-disk cache of results, keyed by the fingerprint of the formula.
+*
+* Every result is stored in its own file, which is written to a temporary name and then renamed,
+*  so concurrent runs sharing the directory never see a partially written entry. When the cache grows
+*  beyond its size limit, the least recently used entries are removed.
+*/
+struct ResultCache {
+    /**
+    * @struct Entry
+    * A cached answer together with the model, if one is known, and the time it took to solve the formula.
+    *  The model is stored with the atoms renamed as in the fingerprint, so every formula sharing the entry
+    *  can map it back to its own atoms.
+    */
+    struct Entry {
+        bool answer = false;
+        std::vector<Literal> model;
+        double solveMilliseconds = 0;
+        size_t clauseCount = 0;
+    };
+
+    std::filesystem::path directory;
+    uintmax_t sizeLimit;
+
+    /**
+    * @brief Creates the cache in the given directory, creating the directory if needed.
+    *
+    * @param path The directory in which the entries are stored.
+    * @param limit The maximum total size of the entries in bytes.
+    */
+    ResultCache(const std::string& path, uintmax_t limit) : directory(path), sizeLimit(limit) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    /**
+    * @brief Looks up the result for the given fingerprint.
+    *
+    * A hit refreshes the modification time of the entry, which is used as its last use by the eviction.
+    *
+    * @param fingerprint The fingerprint of the formula.
+    * @param entry Filled with the cached result on a hit.
+    * @return bool True if the result was found, false otherwise.
+    */
+    bool lookup(const std::string& fingerprint, Entry& entry) {
+        const std::filesystem::path path = directory / (fingerprint + ".result");
+        std::ifstream fin(path);
+        if (!fin) return false;
+
+        std::string key, value;
+        bool complete = false;
+        entry = Entry();
+        while (fin >> key) {
+            if (key == "answer" && fin >> value) entry.answer = value == "true";
+            else if (key == "time") fin >> entry.solveMilliseconds;
+            else if (key == "clauses") fin >> entry.clauseCount;
+            else if (key == "model") {
+                Literal literal;
+                while (fin >> literal && literal != 0) entry.model.push_back(literal);
+            }
+            else if (key == "end") complete = true;
+        }
+        if (!complete) return false;
+
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+        return true;
+    }
+
+    /**
+    * @brief Stores the result for the given fingerprint and evicts old entries if the cache became too large.
+    *
+    * @param fingerprint The fingerprint of the formula.
+    * @param entry The result to be stored.
+    */
+    void store(const std::string& fingerprint, const Entry& entry) {
+        std::random_device rd;
+        const std::filesystem::path path = directory / (fingerprint + ".result");
+        const std::filesystem::path temporary = directory / (fingerprint + "." + std::to_string(rd()) + ".tmp");
+        {
+            std::ofstream fout(temporary);
+            fout << "answer " << (entry.answer ? "true" : "false") << "\n";
+            fout << "time " << entry.solveMilliseconds << "\n";
+            fout << "clauses " << entry.clauseCount << "\n";
+            if (!entry.model.empty()) {
+                fout << "model";
+                for (const Literal& literal : entry.model) fout << " " << literal;
+                fout << " 0\n";
+            }
+            fout << "end\n";
+            if (!fout) return;
+        }
 
-            // Variable to be potentially eliminated
-            const Atom literal = it->first;
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) std::filesystem::remove(temporary, error);
+        else evict();
+    }
 
-            // Get the clauses containing the literal and the clauses containing the negation of the literal
-            auto clausesWith = allClausesWithGivenLiteral(f, literal);
-            auto clausesWithout = allClausesWithGivenLiteral(f, -literal);
+    /**
+    * @brief Removes the least recently used entries until the total size is within the limit.
+    *
+    * Entries removed by another run in the meantime are simply skipped.
+    */
+    void evict() {
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+        uintmax_t total = 0;
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+            if (file.path().extension() != ".result") continue;
+            const uintmax_t size = file.file_size(error);
+            if (error) continue;
+            total += size;
+            entries.emplace_back(file.last_write_time(error), file.path());
+        }
+        if (total <= sizeLimit) return;
 
-            // If any of the sets of clauses is empty, continue to the next literal
-            if (clausesWith.empty() || clausesWithout.empty()) continue;
+        std::sort(entries.begin(), entries.end());
+        for (const auto& entry : entries) {
+            if (total <= sizeLimit) break;
+            const uintmax_t size = std::filesystem::file_size(entry.second, error);
+            if (!error && std::filesystem::remove(entry.second, error)) total -= size;
+        }
+    }
+};
 
-            // Add the resolved clause to the formula
-            for (const Clause& clause1 : clausesWith)
-                for (const Clause& clause2 : clausesWithout) {
-                    Clause resolved = resolve(clause1, clause2, literal);
-                    if (resolved.empty()) {
-                        return false;   // UNSAT - empty clause
-                    }
-                    if (isUnitClause(resolved)) {
-                        falseLiterals.insert(-(*resolved.begin()));
-                        removeFalseLiterals(f, conflict);
-                        if (conflict) return false;   // UNSAT - empty clause
-                    }
-                    if (!isTautologicClause(resolved)) f.insert(resolved);
-                }
+/**
+* @struct Options
+* Represents the command-line options of the program.
+*/
+struct Options {
+    std::string bench;
+    bool batch = false;
+    bool propagateOnParse = false;
+    bool validateInput = false;
+    bool wcnf = false;
+    std::string cacheDirectory;
+    uintmax_t cacheLimit = 64 << 20;
+    bool symmetry = false;
+    long symmetryBudget = 1000;
+    size_t symmetryLength = 2;
+    std::string kbCompile;
+    std::string kbQuery;
+    std::string ddnnfCompile;
+    std::string ddnnfQuery;
+    bool backbone = false;
+    std::string engine;             // empty to choose between DP and its bitset version by the number of atoms
+    int stalmarckDepth = 0;
+    long tdBudget = 1000;
+    int tdMaxWidth = 20;
+    size_t samples = 0;
+    uint64_t seed = std::random_device()();
+    bool features = false;
+    std::string ordering = "occurrence";
+    size_t eliminationBound = SIZE_MAX;
+    bool subsumption = true;
+    bool compress = false;
+    bool subsume = false;
+    bool serve = false;
+    std::string directory;
+    size_t readDepth = 16;
+    uint64_t quantum = 1 << 16;
+    long taskTimeout = 0;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string tuneDirectory;
+    std::string tuneConfigurations;
+    long tuneTimeout = 10000;
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
 
-            // Remove the clauses used for resolution from the formula
-            for (const Clause& clause : clausesWith) f.erase(clause);
-            for (const Clause& clause : clausesWithout) f.erase(clause);
+    /**
+    * @brief Parses the command-line arguments.
+    *
+    * Options with a value are written as --name=value.
+    *
+    * @param argc The number of arguments.
+    * @param argv The arguments, starting with the name of the program.
+    * @return bool True if all arguments are valid, false otherwise.
+    */
+    bool parse(int argc, char* argv[]) {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const size_t equals = arg.find('=');
+            const std::string name = arg.substr(0, equals);
+            const std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
 
-            // Update the list of literals
-            literals.erase(literal);
-            literals.erase(-literal);
-            falseLiterals.erase(literal);
-            falseLiterals.erase(-literal);
+            if (name == "--bench" && (value == "branch" || value == "resolvents" || value == "parse" || value == "bitset" ||
+                                      value == "batch" || value == "subsume" || value == "ingest" || value == "check"))
+                bench = value;
+            else if (arg == "--batch") batch = true;
+            else if (arg == "--propagate-on-parse") propagateOnParse = true;
+            else if (arg == "--validate-input") validateInput = true;
+            else if (arg == "--wcnf") wcnf = true;
+            else if (name == "--cache" && !value.empty()) cacheDirectory = value;
+            else if (name == "--cache-limit" && !value.empty()) cacheLimit = std::stoull(value);
+            else if (arg == "--symmetry") symmetry = true;
+            else if (name == "--symmetry-budget" && !value.empty()) symmetryBudget = std::stol(value);
+            else if (name == "--symmetry-length" && !value.empty()) symmetryLength = std::stoul(value);
+            else if (name == "--kb-compile" && !value.empty()) kbCompile = value;
+            else if (name == "--kb-query" && !value.empty()) kbQuery = value;
+            else if (name == "--ddnnf-compile" && !value.empty()) ddnnfCompile = value;
+            else if (name == "--ddnnf-query" && !value.empty()) ddnnfQuery = value;
+            else if (arg == "--backbone") backbone = true;
+            else if (name == "--engine" && (value == "dp" || value == "bitset" || value == "stalmarck" || value == "td" || value == "cdcl" || value == "auto"))
+                engine = value;
+            else if (name == "--stalmarck" && !value.empty()) stalmarckDepth = std::stoi(value);
+            else if (name == "--td-budget" && !value.empty()) tdBudget = std::stol(value);
+            else if (name == "--td-max-width" && !value.empty()) tdMaxWidth = std::stoi(value);
+            else if (name == "--sample" && !value.empty()) samples = std::stoul(value);
+            else if (name == "--seed" && !value.empty()) seed = std::stoull(value);
+            else if (arg == "--features") features = true;
+            else if (name == "--ordering" && (value == "occurrence" || value == "random")) ordering = value;
+            else if (name == "--elimination-bound" && !value.empty()) eliminationBound = std::stoul(value);
+            else if (arg == "--no-subsumption") subsumption = false;
+            else if (arg == "--compress") compress = true;
+            else if (arg == "--subsume") subsume = true;
+            else if (arg == "--serve") serve = true;
+            else if (name == "--directory" && !value.empty()) directory = value;
+            else if (name == "--read-depth" && !value.empty()) readDepth = std::max(1UL, std::stoul(value));
+            else if (name == "--quantum" && !value.empty()) quantum = std::max(1ULL, std::stoull(value));
+            else if (name == "--task-timeout" && !value.empty()) taskTimeout = std::stol(value);
+            else if (name == "--threads" && !value.empty()) threads = std::stoul(value);
+            else if (name == "--tune" && !value.empty()) tuneDirectory = value;
+            else if (name == "--tune-configs" && !value.empty()) tuneConfigurations = value;
+            else if (name == "--tune-timeout" && !value.empty()) tuneTimeout = std::stol(value);
+            else if (name == "--jobs" && !value.empty()) jobs = std::stoul(value);
+            else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+/**
+* @struct Features
+* Represents cheap structural features of a formula, used to choose the engine and the settings of the elimination.
+*
+* The width is estimated by a minimum degree elimination ordering which stops as soon as it gets wider than
+*  widthCap, so even large formulas are measured quickly.
+*/
+struct Features {
+    static constexpr int widthCap = 64;
+    static constexpr size_t lengthBuckets = 8;   // the last bucket counts all longer clauses as well
+
+    size_t atoms = 0;
+    size_t clauses = 0;
+    std::vector<size_t> clauseLengths = std::vector<size_t>(lengthBuckets + 1, 0);
+    double meanLength = 0;
+    size_t minDegree = 0, maxDegree = 0;
+    double meanDegree = 0, degreeDeviation = 0;
+    double positiveFraction = 0;   // of all literal occurrences
+    double meanImbalance = 0;      // |positive - negative| / occurrences, averaged over atoms
+    size_t binaryClauses = 0;
+    size_t binaryAtoms = 0;        // atoms occurring in binary clauses
+    size_t binaryComponents = 0;
+    size_t largestBinaryComponent = 0;
+    int width = 0;
+    bool widthCapped = false;
+
+    /**
+    * @brief Extracts the features of the formula.
+    *
+    * @param f The normal form of the formula.
+    * @param atomCount The largest atom occurring in the formula; atoms declared in the header but never used are
+    *  not counted, so an oversized header does not cost memory.
+    */
+    Features(const NormalForm& f, Atom atomCount) {
+        clauses = f.size();
+        std::vector<size_t> positive(atomCount + 1, 0), negative(atomCount + 1, 0);
+        std::vector<Atom> parent(atomCount + 1);
+        for (Atom a = 0; a <= atomCount; a++) parent[a] = a;
+        std::function<Atom(Atom)> root = [&parent](Atom a) {
+            while (parent[a] != a) a = parent[a] = parent[parent[a]];
+            return a;
+        };
+        std::vector<bool> inBinary(atomCount + 1, false);
+
+        size_t occurrences = 0, positives = 0;
+        for (const Clause& clause : f) {
+            clauseLengths[std::min(clause.size(), lengthBuckets)]++;
+            occurrences += clause.size();
+            for (const Literal& literal : clause) {
+                if (literal > 0) positive[literal]++, positives++;
+                else negative[-literal]++;
+            }
+
+            if (clause.size() == 2) {
+                binaryClauses++;
+                const Atom a = std::abs(*clause.begin()), b = std::abs(*clause.rbegin());
+                inBinary[a] = inBinary[b] = true;
+                parent[root(a)] = root(b);
+            }
+        }
+        meanLength = clauses ? static_cast<double>(occurrences) / clauses : 0;
+        positiveFraction = occurrences ? static_cast<double>(positives) / occurrences : 0;
+
+        double degreeSquares = 0, imbalance = 0;
+        std::vector<size_t> componentSize(atomCount + 1, 0);
+        minDegree = SIZE_MAX;
+        for (Atom a = 1; a <= atomCount; a++) {
+            const size_t degree = positive[a] + negative[a];
+            if (degree == 0) continue;
+            atoms++;
+            minDegree = std::min(minDegree, degree);
+            maxDegree = std::max(maxDegree, degree);
+            degreeSquares += static_cast<double>(degree) * degree;
+            imbalance += std::abs(static_cast<double>(positive[a]) - negative[a]) / degree;
+
+            if (inBinary[a]) {
+                binaryAtoms++;
+                if (componentSize[root(a)]++ == 0) binaryComponents++;
+                largestBinaryComponent = std::max(largestBinaryComponent, componentSize[root(a)]);
+            }
+        }
+        if (atoms == 0) minDegree = 0;
+        else {
+            meanDegree = static_cast<double>(occurrences) / atoms;
+            degreeDeviation = std::sqrt(std::max(0.0, degreeSquares / atoms - meanDegree * meanDegree));
+            meanImbalance = imbalance / atoms;
+        }
+
+        TreeDecomposition decomposition;
+        widthCapped = !decomposition.decompose(f, std::chrono::milliseconds(0), widthCap);
+        width = decomposition.width;
+    }
+
+    /**
+    * @brief Writes the features as a JSON object.
+    */
+    std::string toJson() const {
+        std::ostringstream out;
+        out << "{\"atoms\": " << atoms << ", \"clauses\": " << clauses << ", \"clauseLengths\": [";
+        for (size_t i = 0; i < clauseLengths.size(); i++) out << (i ? ", " : "") << clauseLengths[i];
+        out << "], \"meanLength\": " << meanLength
+            << ", \"minDegree\": " << minDegree << ", \"maxDegree\": " << maxDegree
+            << ", \"meanDegree\": " << meanDegree << ", \"degreeDeviation\": " << degreeDeviation
+            << ", \"positiveFraction\": " << positiveFraction << ", \"meanImbalance\": " << meanImbalance
+            << ", \"binaryClauses\": " << binaryClauses << ", \"binaryAtoms\": " << binaryAtoms
+            << ", \"binaryComponents\": " << binaryComponents << ", \"largestBinaryComponent\": " << largestBinaryComponent
+            << ", \"width\": " << width << ", \"widthCapped\": " << (widthCapped ? "true" : "false") << "}";
+        return out.str();
+    }
+
+    /**
+    * @brief Chooses the engine and the settings of the elimination by rules on the features.
+    *
+    * Narrow formulas go to tree decomposition, and formulas too large for elimination go to CDCL. Formulas
+    *  dominated by binary clauses are preprocessed by the dilemma rule before DP elimination, where homogeneous
+    *  formulas get a random order and formulas with frequent atoms bound the growth of each elimination step.
+    *  The remaining formulas are small enough for the bitset engine.
+    *
+    * @param options The options given on the command line.
+    * @return Options The options with the chosen configuration.
+    */
+    Options select(Options options) const {
+        options.engine = "dp";
+        if (clauses == 0) return options;
+
+        if (!widthCapped && width <= 16) options.engine = "td";
+        else if (atoms > 200 || (atoms > 50 && width > 24)) options.engine = "cdcl";
+        else if (binaryClauses * 2 <= clauses) options.engine = "bitset";
+        else {
+            options.stalmarckDepth = std::max(options.stalmarckDepth, 1);
+            if (meanDegree > 0 && degreeDeviation / meanDegree < 0.25) options.ordering = "random";
+            if (meanDegree > 8) options.eliminationBound = 16;
+        }
+
+        return options;
+    }
+};
+
+/**
+* @struct SolveService
+* Represents a service solving many formulas at once on a few threads, in slices of DP elimination.
+*
+* Every request becomes a task with its own solver. The reader thread parses the formula and prepares its
+*  elimination, which take time linear in its size, before queueing it. A worker takes the task at the front of
+*  the queue, runs its elimination for one quantum of effort and puts it back at the end unless it is done, so long
+*  solves share the threads fairly with short ones. Cancelled and timed out tasks are dropped the next time they
+*  are taken, at most one quantum later.
+*/
+struct SolveService {
+    /**
+    * @struct Task
+    * Represents a request together with the solver working on it.
+    */
+    struct Task {
+        size_t id;
+        DP solver;
+        NormalForm f;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    const Options& options;
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<std::unique_ptr<Task>> queue;
+    std::set<size_t> unfinished;     // ids submitted and not answered yet
+    std::set<size_t> cancelled;      // a subset of unfinished
+    bool closed = false;
+
+    std::mutex outputMutex;
+    std::atomic<size_t> slices{ 0 };
+    size_t finished = 0;
+    double totalLatency = 0;
+    double maxLatency = 0;
+
+    explicit SolveService(const Options& configuration) : options(configuration) {}
+
+    /**
+    * @brief Parses the formula and queues a new task for it, or answers it at once if parsing found a conflict.
+    */
+    void submit(size_t id, const std::string& text) {
+        auto task = std::make_unique<Task>();
+        task->id = id;
+        task->submitted = std::chrono::steady_clock::now();
+        task->solver.randomOrder = options.ordering == "random";
+        task->solver.eliminationBound = options.eliminationBound;
+        task->solver.subsumption = options.subsumption;
+        task->solver.resolvents.compress = task->solver.narrowResolvents.compress = options.compress;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            unfinished.insert(id);
+        }
+
+        std::istringstream fin(text);
+        task->f = task->solver.parse(fin);
+        if (task->solver.parseConflict) {
+            report(*task, "false");
+            return;
+        }
+        task->solver.startSolving(task->f);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(task));
+        }
+        available.notify_one();
+    }
+
+    /**
+    * @brief Cancels the task with the given id, if it is still running.
+    *
+    * @return bool True if the task was submitted and is not answered yet, false otherwise.
+    */
+    bool cancel(size_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (unfinished.count(id) == 0) return false;
+        cancelled.insert(id);
+        return true;
+    }
+
+    /**
+    * @brief Prints the answer of the task and records its latency.
+    */
+    void report(const Task& task, const char* answer) {
+        const double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - task.submitted).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            unfinished.erase(task.id);
+            cancelled.erase(task.id);
+        }
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << task.id << " " << answer << std::endl;
+        finished++;
+        totalLatency += latency;
+        maxLatency = std::max(maxLatency, latency);
+    }
+
+    /**
+    * @brief Runs slices of the queued tasks until the input is closed and no task is left.
+    */
+    void work() {
+        while (true) {
+            std::unique_ptr<Task> task;
+            bool isCancelled;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this] { return !queue.empty() || closed; });
+                if (queue.empty()) return;
+                task = std::move(queue.front());
+                queue.pop_front();
+                isCancelled = cancelled.erase(task->id) > 0;
+            }
+
+            if (isCancelled) {
+                report(*task, "cancelled");
+                continue;
+            }
+            if (options.taskTimeout > 0 &&
+                std::chrono::steady_clock::now() - task->submitted > std::chrono::milliseconds(options.taskTimeout)) {
+                report(*task, "timeout");
+                continue;
+            }
+
+            const DP::Progress progress = task->solver.eliminate(task->f, options.quantum);
+            slices++;
+            if (progress != DP::Running) {
+                report(*task, progress == DP::Satisfiable ? "true" : "false");
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(std::move(task));
+            }
+            available.notify_one();
+        }
+    }
+
+    /**
+    * @brief Reads requests from the input and answers them, running the workers until all tasks are done.
+    *
+    * A formula starts at its "p cnf" header and is submitted at the next header, at a line "%" or at the end
+    *  of the input. A line "x ID" cancels the formula with the given id, counting formulas from 1. Cancel lines
+    *  without a valid id, or with the id of a formula not submitted yet or already answered, are reported and ignored.
+    *
+    * @param fin The input stream with the requests.
+    * @return size_t The number of submitted formulas.
+    */
+    size_t serve(std::istream& fin) {
+        // Reading the input and writing warnings would flush the answers the workers are printing, from another thread
+        std::ostream* const inputTie = fin.tie(nullptr);
+        std::ostream* const errorTie = std::cerr.tie(nullptr);
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < std::max<size_t>(options.threads, 1); t++) workers.emplace_back([this] { work(); });
+
+        size_t submitted = 0;
+        std::string line, text;
+        bool content = false;
+        auto submitPending = [&]() {
+            if (content) submit(++submitted, text);
+            text.clear();
+            content = false;
+        };
+
+        while (std::getline(fin, line)) {
+            const size_t first = line.find_first_not_of(" \t\r");
+            const char kind = first == std::string::npos ? ' ' : line[first];
+            if (kind == '%') submitPending();
+            else if (kind == 'x') {
+                const size_t start = std::min(line.find_first_not_of(" \t", first + 1), line.size());
+                size_t id = 0;
+                const auto [end, error] = std::from_chars(line.data() + start, line.data() + line.size(), id);
+                const bool valid = error == std::errc() &&
+                                   line.find_first_not_of(" \t\r", end - line.data()) == std::string::npos;
+                if (!valid) std::cerr << "Warning: ignoring malformed cancel request \"" << line << "\"" << std::endl;
+                else if (!cancel(id))
+                    std::cerr << "Warning: ignoring cancel request \"" << line << "\", no such formula is running" << std::endl;
+            }
+            else {
+                if (kind == 'p') submitPending();  // a header starts the next formula
+                content = content || (kind != 'c' && kind != ' ');
+                text += line;
+                text += '\n';
+            }
         }
+        submitPending();
 
-        return solve(f);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        available.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        fin.tie(inputTie);
+        std::cerr.tie(errorTie);
+        return submitted;
     }
 };
 
-int main()
+/**
+* @brief Detects symmetries of the formula and adds clauses breaking them before elimination.
+*
+* @param solver The solver whose set of literals is extended with the fresh atoms.
+* @param f The normal form of the formula, which will be modified.
+* @param options The options with the time budget and the maximum length of the lex-leader constraints.
+*/
+void addSymmetryBreakingClauses(DP& solver, NormalForm& f, const Options& options) {
+    SymmetryBreaker breaker(f, std::chrono::milliseconds(options.symmetryBudget));
+    const std::vector<SymmetryBreaker::Permutation> generators = breaker.findGenerators();
+
+    Atom nextAtom = std::max(solver.maxAtom, solver.atomCount) + 1;
+    std::vector<Clause> clauses;
+    for (const auto& generator : generators)
+        for (Clause& clause : breaker.lexLeader(generator, options.symmetryLength, nextAtom))
+            clauses.push_back(std::move(clause));
+
+    for (const Clause& clause : clauses) {
+        for (const Literal& literal : clause) solver.literals.insert(literal);
+        f.insert(clause);
+    }
+    solver.maxAtom = std::max(solver.maxAtom, nextAtom - 1);
+
+    std::cerr << "c symmetry: " << generators.size() << " generators, " << clauses.size() << " clauses"
+              << (breaker.timedOut ? " (time budget exceeded)" : "") << std::endl;
+}
+
+/**
+* @brief Answers queries read from the given input stream using a compiled knowledge base.
+*
+* Every query is a list of assumed literals terminated by 0. The answer is true followed by a model, false, or unknown
+*  for a query which cannot be decided in linear time.
+*
+* @param kb The compiled knowledge base.
+* @param fin The input stream with the queries.
+*/
+void answerQueries(const DirectionalResolution& kb, std::istream& fin) {
+    std::vector<Literal> assumptions, model;
+    Literal literal;
+    while (fin >> literal) {
+        if (literal != 0) {
+            assumptions.push_back(literal);
+            continue;
+        }
+
+        const DirectionalResolution::Result result = kb.query(assumptions, model);
+        if (result == DirectionalResolution::Consistent) {
+            std::cout << "true" << std::endl << "v";
+            for (const Literal& value : model) std::cout << " " << value;
+            std::cout << " 0" << std::endl;
+        }
+        else std::cout << (result == DirectionalResolution::Inconsistent ? "false" : "unknown") << std::endl;
+        assumptions.clear();
+    }
+}
+
+/**
+* @brief Answers counting queries read from the given input stream using a compiled circuit.
+*
+* Every query is either count or marginals, followed by a list of assumed literals terminated by 0.
+*  The answer to count is the number of models under the assumptions, and the answer to marginals is a line
+*  with the number of such models for every literal.
+*
+* @param circuit The compiled circuit.
+* @param fin The input stream with the queries.
+*/
+void answerCountingQueries(const DecisionDNNF& circuit, std::istream& fin) {
+    std::string query;
+    while (fin >> query) {
+        std::vector<Literal> assumptions;
+        Literal literal;
+        while (fin >> literal && literal != 0) assumptions.push_back(literal);
+
+        if (query == "count") std::cout << circuit.count(assumptions).toString() << std::endl;
+        else if (query == "marginals") {
+            for (const auto& marginal : circuit.marginals(assumptions))
+                std::cout << marginal.first << ":" << marginal.second.toString() << " ";
+            std::cout << std::endl;
+        }
+        else std::cerr << "Unknown query: " << query << std::endl;
+    }
+}
+
+/**
+* @brief Decides the formula with the engine and the preprocessing selected by the options.
+*
+* Unless an engine is chosen, formulas with at most 256 atoms are eliminated by the bitset version of DP.
+*
+* @param solver The solver which owns the state of the formula.
+* @param f The normal form of the formula, which will be modified.
+* @param options The options with the engine, its limits and the depth of the Stålmarck preprocessing.
+* @param model If given, filled with a model of the formula when the engine finds one, one literal per atom.
+*  Only CDCL without the Stålmarck preprocessing, which may drop clauses, finds models; otherwise it stays empty.
+* @return bool True if the formula is satisfiable, false otherwise.
+*/
+bool solveFormula(DP& solver, NormalForm& f, const Options& options, std::vector<Literal>* model = nullptr) {
+    solver.randomOrder = options.ordering == "random";
+    solver.eliminationBound = options.eliminationBound;
+    solver.subsumption = options.subsumption;
+    solver.resolvents.compress = solver.narrowResolvents.compress = options.compress;
+
+    if (options.engine == "stalmarck") {
+        Stalmarck engine(solver, f);
+        const bool answer = engine.solve();
+        std::cerr << "c stalmarck: depth " << engine.depth << ", " << engine.dilemmas << " dilemmas" << std::endl;
+        return answer;
+    }
+
+    if (options.stalmarckDepth > 0) {
+        Stalmarck preprocessor(solver, f);
+        if (!preprocessor.simplify() || !preprocessor.saturate(options.stalmarckDepth)) return false;
+        if (preprocessor.satisfiable) return true;
+        if (!preprocessor.simplify()) return false;
+        if (f.empty()) return true;
+        std::cerr << "c stalmarck: " << preprocessor.dilemmas << " dilemmas, " << f.size() << " clauses left" << std::endl;
+    }
+
+    if (options.subsume) {
+        Subsumption pass(solver, f, options.threads);
+        auto start = std::chrono::steady_clock::now();
+        const bool consistent = pass.run();
+        std::cerr << "c subsume: " << pass.subsumed << " subsumed, " << pass.strengthened << " strengthened in " << pass.rounds
+                  << " rounds, " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                  << " ms with " << pass.threads << " threads" << std::endl;
+        if (!consistent) return false;  // UNSAT - empty clause
+        if (f.empty()) return true;  // SAT - formula is empty
+    }
+
+    if (options.engine == "cdcl") {
+        CDCL engine;
+        engine.reserveAtoms(solver.maxAtom);
+        for (const Clause& clause : f)
+            if (!engine.addClause(std::vector<Literal>(clause.begin(), clause.end()))) return false;  // UNSAT - empty clause
+        if (engine.solve() != CDCL::Satisfiable) return false;
+        if (model && options.stalmarckDepth == 0) *model = engine.model;
+        return true;
+    }
+
+    if (options.engine == "td") {
+        bool conflict = false;
+        solver.removeAllTautologyClauses(f);
+        solver.removeUnitClauses(f, conflict);
+        if (conflict) return false;  // UNSAT - empty clause
+        solver.removePureClauses(f);
+        if (f.empty()) return true;  // SAT - formula is empty
+
+        TreeDecomposition decomposition;
+        if (decomposition.decompose(f, std::chrono::milliseconds(options.tdBudget), options.tdMaxWidth)) {
+            std::cerr << "c td: width " << decomposition.width << (decomposition.minFillTimedOut ? ", min-degree" : ", min-fill")
+                      << std::endl;
+            return decomposition.solve(f);
+        }
+        std::cerr << "c td: width above " << options.tdMaxWidth << ", falling back to elimination" << std::endl;
+    }
+
+    if (options.engine.empty() || options.engine == "bitset") {
+        if (BitsetDP::fits(f)) {
+            BitsetDP engine;
+            engine.load(f);
+            return engine.solve();
+        }
+        if (options.engine == "bitset")
+            std::cerr << "c bitset: more than " << BitsetDP::maxAtoms << " atoms, falling back to elimination" << std::endl;
+    }
+
+    return solver.solve(f);
+}
+
+/**
+* @brief Lists the regular files of the directory in sorted order.
+*/
+std::vector<std::string> directoryFiles(const std::string& directory) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(directory, error))
+        if (file.is_regular_file()) paths.push_back(file.path().string());
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+/**
+* @brief Solves every file of the directory, parsing each as soon as its reads complete, and prints the answers by path.
+*
+* @param options The options with the directory, the number of reads in flight and the settings of the solver.
+*/
+void solveDirectory(const Options& options) {
+    InputReader reader;
+    reader.depth = options.readDepth;
+    std::vector<std::pair<std::string, bool>> answers;
+
+    auto start = std::chrono::steady_clock::now();
+    reader.read(directoryFiles(options.directory), [&](const std::string& path, std::string& data) {
+        MemoryBuffer buffer(data.data(), data.size());
+        std::istream fin(&buffer);
+        DP solver;
+        solver.propagateOnParse = options.propagateOnParse;
+        solver.headerlessWeighted = options.wcnf;
+        NormalForm f = solver.parse(fin);
+        answers.emplace_back(path, !solver.parseConflict && solveFormula(solver, f, options));
+    });
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+    std::sort(answers.begin(), answers.end());
+    for (const auto& [path, answer] : answers) std::cout << path << " " << (answer ? "true" : "false") << std::endl;
+    std::cerr << "c directory: " << answers.size() << " files, " << reader.bytes << " bytes in " << time.count() << " ms, "
+              << (reader.usedUring ? "io_uring" : "blocking reads") << std::endl;
+}
+
+/**
+* @brief Measures the throughput of reading every file of the directory, alone and together with parsing,
+*  with blocking reads and with io_uring.
+*
+* The files stay in the page cache between the runs unless it is dropped, so on a warm cache the reads cost
+*  little and the runs show mostly how much of the parsing the reads in flight overlap with.
+*
+* @param options The options with the directory and the number of reads in flight.
+*/
+void benchmarkIngestion(const Options& options) {
+    const std::vector<std::string> paths = directoryFiles(options.directory);
+    for (bool parse : { false, true })
+        for (bool asynchronous : { false, true }) {
+            InputReader reader;
+            reader.depth = options.readDepth;
+            reader.asynchronous = asynchronous;
+            size_t files = 0, clauses = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            reader.read(paths, [&](const std::string&, std::string& data) {
+                files++;
+                if (!parse) return;
+                MemoryBuffer buffer(data.data(), data.size());
+                std::istream fin(&buffer);
+                DP solver;
+                clauses += solver.parse(fin).size();
+            });
+            std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+            if (asynchronous && !reader.usedUring) {
+                std::cout << "c io_uring: not available" << std::endl;
+                continue;
+            }
+            std::cout << "c " << (asynchronous ? "io_uring" : "blocking") << (parse ? " read and parse: " : " read: ") << files
+                      << " files, " << (parse ? std::to_string(clauses) + " clauses, " : "") << time.count() * 1000 << " ms, "
+                      << reader.bytes / std::max(time.count(), 1e-9) / (1 << 20) << " MiB/s, "
+                      << files / std::max(time.count(), 1e-9) << " files/s" << std::endl;
+        }
+}
+
+int main(int argc, char* argv[])
 {
+    Options options;
+    if (!options.parse(argc, argv)) return 1;
+
+    std::ios::sync_with_stdio(false);
+    if (!options.kbQuery.empty()) {
+        DirectionalResolution kb;
+        std::ifstream fin(options.kbQuery);
+        if (!kb.load(fin)) {
+            std::cerr << "Cannot read the knowledge base " << options.kbQuery << std::endl;
+            return 1;
+        }
+        answerQueries(kb, std::cin);
+        return 0;
+    }
+    if (!options.ddnnfQuery.empty()) {
+        DecisionDNNF circuit;
+        std::ifstream fin(options.ddnnfQuery);
+        if (!circuit.load(fin)) {
+            std::cerr << "Cannot read the circuit " << options.ddnnfQuery << std::endl;
+            return 1;
+        }
+        answerCountingQueries(circuit, std::cin);
+        return 0;
+    }
+    if (!options.tuneDirectory.empty()) {
+        const std::string executable = std::filesystem::exists("/proc/self/exe") ? "/proc/self/exe" : argv[0];
+        Tuner tuner(executable, options.tuneDirectory, options.tuneTimeout, options.jobs);
+        if (options.tuneConfigurations.empty()) tuner.addDefaultConfigurations();
+        else {
+            std::ifstream fin(options.tuneConfigurations);
+            tuner.readConfigurations(fin);
+        }
+        if (tuner.corpus.empty() || tuner.configurations.empty()) {
+            std::cerr << "Nothing to tune: no formulas in " << options.tuneDirectory << " or no configurations" << std::endl;
+            return 1;
+        }
+
+        const Tuner::Configuration* best = tuner.race();
+        for (const Tuner::Configuration& configuration : tuner.configurations) {
+            std::cerr << "c tune: " << configuration.label() << ": PAR-2 " << configuration.total() / configuration.times.size()
+                      << " ms, median " << configuration.median() << " ms, solved " << configuration.solved << " of "
+                      << configuration.times.size();
+            if (configuration.eliminatedAfter) std::cerr << ", eliminated after " << configuration.eliminatedAfter << " formulas";
+            std::cerr << std::endl;
+        }
+        if (!best) return 1;
+
+        std::cout << "best: " << best->label() << std::endl
+                  << "median: " << best->median() << " ms, PAR-2: " << best->total() / best->times.size() << " ms, solved "
+                  << best->solved << " of " << tuner.corpus.size() << std::endl;
+        return 0;
+    }
+    if (!options.directory.empty()) {
+        if (options.bench == "ingest") benchmarkIngestion(options);
+        else solveDirectory(options);
+        return 0;
+    }
+    if (options.bench == "ingest") {
+        std::cerr << "--bench=ingest needs --directory" << std::endl;
+        return 1;
+    }
+    if (options.serve) {
+        SolveService service(options);
+        const size_t tasks = service.serve(std::cin);
+        std::cerr << "c serve: " << tasks << " tasks, " << service.slices << " slices on " << options.threads << " threads, latency "
+                  << service.totalLatency / std::max<size_t>(service.finished, 1) << " ms on average, " << service.maxLatency
+                  << " ms at most" << std::endl;
+        return 0;
+    }
+    if (options.batch || options.bench == "batch") {
+        std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        if (options.bench == "batch") {
+            benchmarkBatch(input);
+            return 0;
+        }
+
+        BatchSolver batch;
+        auto start = std::chrono::steady_clock::now();
+        const size_t count = batch.solve(input, [](bool answer) { std::cout << (answer ? "true" : "false") << '\n'; });
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        std::cout.flush();
+        std::cerr << "c batch: " << count << " formulas, " << batch.tableSolved << " by truth tables, " << time.count() * 1000
+                  << " ms, " << count / std::max(time.count(), 1e-9) << " formulas/s" << std::endl;
+        return 0;
+    }
+    if (options.bench == "parse") {
+        std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        benchmarkParsing(input, 5);
+        return 0;
+    }
+    if (options.bench == "check") {
+        std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        return checkStructures(input) ? 0 : 1;
+    }
+
     DP solver;
+    solver.propagateOnParse = options.propagateOnParse;
+    solver.validateInput = options.validateInput;
+    solver.headerlessWeighted = options.wcnf;
     NormalForm formula = solver.parse( std::cin);
+    if (solver.parseError) return 1;
+
+    if (options.bench == "branch") {
+        benchmarkBranching(formula, 100);
+        return 0;
+    }
+    if (options.bench == "resolvents") {
+        benchmarkResolvents(formula);
+        return 0;
+    }
+    if (options.bench == "bitset") {
+        benchmarkBitset(formula);
+        return 0;
+    }
+    if (options.bench == "subsume") {
+        benchmarkSubsumption(formula, options.threads);
+        return 0;
+    }
+
+    if (!options.kbCompile.empty()) {
+        DirectionalResolution kb;
+        kb.compile(formula);
+        std::ofstream fout(options.kbCompile);
+        kb.save(fout);
+        std::cout << (kb.consistent ? "true" : "false") << std::endl;
+        return 0;
+    }
+
+    if (!options.ddnnfCompile.empty()) {
+        DecisionDNNF circuit;
+        circuit.compile(formula, std::max(solver.atomCount, solver.maxAtom));
+        std::ofstream fout(options.ddnnfCompile);
+        circuit.save(fout);
+        std::cout << circuit.count({}).toString() << std::endl;
+        return 0;
+    }
+
+    if (options.backbone) {
+        Backbone engine;
+        std::vector<Literal> backbone;
+        auto start = std::chrono::steady_clock::now();
+        const bool satisfiable = engine.compute(formula, backbone);
+        std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+        std::cout << (satisfiable ? "true" : "false") << std::endl;
+        if (satisfiable) {
+            std::cout << "b";
+            for (const Literal& literal : backbone) std::cout << " " << literal;
+            std::cout << " 0" << std::endl;
+        }
+        std::cerr << "c backbone: " << backbone.size() << " literals, " << engine.calls << " solver calls, "
+                  << time.count() << " ms" << std::endl;
+        return 0;
+    }
+
+    if (options.samples > 0) {
+        XorSampler sampler(options.seed);
+        size_t drawn = 0;
+        auto start = std::chrono::steady_clock::now();
+        const bool satisfiable = !solver.parseConflict &&
+            sampler.sample(formula, std::max(solver.atomCount, solver.maxAtom), options.samples, [&drawn](const std::vector<Literal>& model) {
+                if (drawn++ == 0) std::cout << "true" << std::endl;
+                std::cout << "v";
+                for (const Literal& literal : model) std::cout << " " << literal;
+                std::cout << " 0" << std::endl;
+            });
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+        if (!satisfiable) std::cout << "false" << std::endl;
+        std::cerr << "c sample: seed " << options.seed << ", " << drawn << " samples in " << time.count() * 1000 << " ms, "
+                  << drawn / std::max(time.count(), 1e-9) << " samples/s, " << sampler.calls << " solver calls" << std::endl;
+        return 0;
+    }
+
+    if (solver.weighted) {
+        MaxSAT engine;
+        engine.onImprovement = [](uint64_t cost) { std::cout << "o " << cost << std::endl; };
+        if (solver.parseConflict || !engine.solve(formula, solver.softClauses, std::max(solver.atomCount, solver.maxAtom))) {
+            std::cout << "s UNSATISFIABLE" << std::endl;
+            return 0;
+        }
+
+        std::cout << "s OPTIMUM FOUND" << std::endl << "v";
+        for (const Literal& literal : engine.bestModel) std::cout << " " << literal;
+        std::cout << std::endl;
+        std::cerr << "c maxsat: " << engine.calls << " solver calls, " << engine.totalizers.size() << " totalizers" << std::endl;
+        return 0;
+    }
+
+    if (options.features || options.engine == "auto") {
+        const Features features(formula, solver.maxAtom);
+        if (options.features) {
+            std::cout << features.toJson() << std::endl;
+            return 0;
+        }
+
+        options = features.select(options);
+        std::cerr << "c auto: engine " << options.engine << ", ordering " << options.ordering << ", elimination bound "
+                  << (options.eliminationBound == SIZE_MAX ? std::string("none") : std::to_string(options.eliminationBound))
+                  << ", stalmarck depth " << options.stalmarckDepth << std::endl;
+    }
+
+    if (solver.parseConflict) {
+        std::cout << "false" << std::endl;
+        return 0;
+    }
+
+    // Answer from the cache if the same formula was already solved
+    std::unique_ptr<ResultCache> cache;
+    std::string fingerprint;
+    std::vector<Atom> renamedAtoms;
+    ResultCache::Entry entry;
+
+    // Maps the model of the entry back to the atoms of this formula, sorted by atom
+    auto entryModel = [&renamedAtoms, &entry]() {
+        std::vector<Literal> model;
+        for (const Literal& literal : entry.model) {
+            if (literal == 0 || static_cast<size_t>(std::abs(literal)) > renamedAtoms.size()) return std::vector<Literal>();
+            model.push_back(literal > 0 ? renamedAtoms[literal - 1] : -renamedAtoms[-literal - 1]);
+        }
+        std::sort(model.begin(), model.end(), [](const Literal& a, const Literal& b) { return std::abs(a) < std::abs(b); });
+        return model;
+    };
+    auto printEntry = [&entry](const std::vector<Literal>& model) {
+        std::cout << (entry.answer == true ? "true" : "false") << std::endl;
+        if (model.empty()) return;
+        std::cout << "v";
+        for (const Literal& literal : model) std::cout << " " << literal;
+        std::cout << " 0" << std::endl;
+    };
+
+    if (!options.cacheDirectory.empty()) {
+        cache = std::make_unique<ResultCache>(options.cacheDirectory, options.cacheLimit);
+        fingerprint = formulaFingerprint(formula, renamedAtoms);
+        if (cache->lookup(fingerprint, entry)) {
+            // A cached model which does not satisfy the formula means a fingerprint collision, so the formula is solved
+            const std::vector<Literal> model = entryModel();
+            const std::set<Literal> values(model.begin(), model.end());
+            const bool satisfied = std::all_of(formula.begin(), formula.end(), [&values](const Clause& clause) {
+                return std::any_of(clause.begin(), clause.end(), [&values](const Literal& literal) { return values.count(literal); });
+            });
+            if (entry.model.empty() || (entry.answer && model.size() == renamedAtoms.size() && satisfied)) {
+                printEntry(model);
+                return 0;
+            }
+        }
+        entry = ResultCache::Entry();
+        entry.clauseCount = formula.size();
+    }
+
+    if (options.symmetry) addSymmetryBreakingClauses(solver, formula, options);
+
+    std::vector<Literal> model;
+    auto start = std::chrono::steady_clock::now();
+    entry.answer = solveFormula(solver, formula, options, cache ? &model : nullptr);
+    entry.solveMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (cache) {
+        // The model is stored with the atoms renamed as in the fingerprint
+        if (!model.empty())
+            for (size_t i = 0; i < renamedAtoms.size(); i++) {
+                const Literal value = model[renamedAtoms[i] - 1];
+                entry.model.push_back(value > 0 ? static_cast<Literal>(i + 1) : -static_cast<Literal>(i + 1));
+            }
+        cache->store(fingerprint, entry);
+    }
 
-    std::cout << (solver.solve(formula) == true ? "true" : "false") << std::endl;
+    printEntry(entryModel());
 }
\ No newline at end of file
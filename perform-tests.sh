@@ -12,29 +12,92 @@ if [ $? -ne 0 ]; then
   exit 1
 fi
 
-# Folder sa test primerima
+# Ako procesor podrzava AVX2, prevodi se i verzija koja koristi AVX2 instrukcije u bitset verziji DP algoritma
+avx2=""
+if grep -q avx2 /proc/cpuinfo 2> /dev/null; then
+  g++ -mavx2 -o dp_algorithm_avx2 main.cpp
+  avx2="dp_algorithm_avx2"
+fi
+
+# Folder sa test primerima i folder sa ocekivanim izlazima
 input_dir="test-cases-in"
 output_dir="test-cases-out"
+actual_file=$(mktemp)
+failed=0
 
-# Kreiraj direktorijum ukoliko vec ne postoji
-if [ ! -d "$output_dir" ]; then
-  mkdir -p "$output_dir"
-fi
+# Pokretanje DP algoritma za svaki test primer i poredjenje sa ocekivanim izlazom.
+# Opcije komandne linije za test primer se, ako postoje, nalaze u datoteci testN-args.txt
+for input_file in $(ls "$input_dir"/test*-in.txt | sort -V); do
+  name=$(basename "$input_file" -in.txt)
+  output_file="${output_dir}/${name}-out.txt"
+  args_file="${input_dir}/${name}-args.txt"
+
+  args=""
+  if [ -f "$args_file" ]; then
+    args=$(cat "$args_file")
+  fi
+
+  # Prosleđivanje sadržaja ulazne datoteke na ulaz programu
+  ./dp_algorithm $args < "$input_file" > "$actual_file" 2> /dev/null || true
+
+  if ! diff -q "$output_file" "$actual_file" > /dev/null 2>&1; then
+    echo "Test $name nije prošao:"
+    diff "$output_file" "$actual_file" || true
+    failed=$((failed + 1))
+  fi
 
-# Pokretanje DP algoritma za svaki test primer
-for i in {1..10}; do
-  input_file="${input_dir}/test${i}-in.txt"
-  output_file="${output_dir}/test${i}-out.txt"
+  # Opsta verzija DP algoritma i bitset verzija sa AVX2 instrukcijama moraju da daju iste odgovore
+  # kao podrazumevana, koja male formule resava bitset verzijom
+  if [ ! -f "$args_file" ]; then
+    if [ "$(./dp_algorithm --engine=dp < "$input_file" 2> /dev/null)" != "$(cat "$output_file")" ]; then
+      echo "Opsta verzija daje drugaciji odgovor za $input_file!"
+      failed=$((failed + 1))
+    fi
+    if [ -n "$avx2" ] && [ "$(./$avx2 < "$input_file" 2> /dev/null)" != "$(cat "$output_file")" ]; then
+      echo "Bitset verzija sa AVX2 instrukcijama daje drugaciji odgovor za $input_file!"
+      failed=$((failed + 1))
+    fi
 
-  # Provera postojanja ulazne datoteke
-  if [ -f "$input_file" ]; then
-    # Prosleđivanje sadržaja ulazne datoteke na ulaz programu
-    # i upisivanje izlaza u izlaznu datoteku
-    ./dp_algorithm < "$input_file" > "$output_file"
+    # Provera internih struktura podataka na formuli
+    if ! ./dp_algorithm --bench=check < "$input_file" > "$actual_file" 2>&1; then
+      echo "Provera internih struktura nije prosla za $input_file:"
+      grep MISMATCH "$actual_file" || true
+      failed=$((failed + 1))
+    fi
   fi
 done
 
+# Kes rezultata: test28 se resava CDCL algoritmom i upisuje u kes zajedno sa modelom, test29 je ista formula
+# sa preimenovanim atomima pa se model cita iz kesa; sa ogranicenjem od 1 bajta unos se odmah izbacuje
+cache_dir=$(mktemp -d)
+check_cache() {
+  if [ "$(./dp_algorithm "${@:3}" < "$1" 2> /dev/null)" != "$(printf "$2")" ]; then
+    echo "Kes daje neocekivan izlaz za $1 uz opcije ${*:3}!"
+    failed=$((failed + 1))
+  fi
+}
+check_cache "$input_dir/test28-in.txt" 'true\nv 1 -2 -3 0' --cache="$cache_dir/hit" --engine=cdcl
+check_cache "$input_dir/test29-in.txt" 'true\nv -3 -5 8 0' --cache="$cache_dir/hit"
+check_cache "$input_dir/test28-in.txt" 'true\nv 1 -2 -3 0' --cache="$cache_dir/evicted" --cache-limit=1 --engine=cdcl
+check_cache "$input_dir/test29-in.txt" 'true' --cache="$cache_dir/evicted" --cache-limit=1
+rm -rf "$cache_dir"
+
+# Trka konfiguracija nad dve formule iz foldera tune-dir: druga konfiguracija ima nepoznatu opciju pa ne resava
+# nijednu formulu i najbolja mora biti prva; vremena se ne porede jer zavise od racunara
+tune_output=$(./dp_algorithm --tune="$input_dir/tune-dir" --tune-configs="$input_dir/tune-configs.txt" 2> /dev/null | \
+  sed 's/^median: .* ms, solved/solved/')
+if [ "$tune_output" != "$(printf 'best: --engine=dp\nsolved 2 of 2')" ]; then
+  echo "Trka konfiguracija daje neocekivan izlaz:"
+  echo "$tune_output"
+  failed=$((failed + 1))
+fi
+
 # Obrisi izvrsnu datoteku
-rm dp_algorithm
+rm -f dp_algorithm dp_algorithm_avx2 "$actual_file"
+
+if [ $failed -ne 0 ]; then
+  echo "Testiranje nije uspelo: $failed test(ova) ne daje ocekivani izlaz."
+  exit 1
+fi
 
-echo "Testiranje je završeno. Rezultati su smešteni u folderu $output_dir."
+echo "Testiranje je završeno. Svi testovi iz foldera $input_dir daju ocekivane izlaze iz foldera $output_dir."